@@ -0,0 +1,167 @@
+/* bench.c
+ *
+ * Framework for benchmarks of the game engine.  Each benchmark writes one
+ * line of JSON to standard output, with the time and the number of
+ * allocations for each of the operations it times.
+ */
+
+#include "angband.h"
+#include "bench.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "player-birth.h"
+#include "player-util.h"
+#include "test-utils.h"
+#include <locale.h>
+
+/* Wanted by test-utils.c */
+int verbose = 0;
+int forcepath = 0;
+
+/* Names given on the command line, to run only the benchmarks they start */
+static char **bench_only;
+static int bench_only_count;
+
+/* Time and allocations so far for the benchmark being run */
+static uint64_t bench_start;
+static uint64_t bench_ns;
+static unsigned long bench_allocs;
+
+static uint64_t bench_now(void)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#else
+	return (uint64_t) clock() * (1000000000 / CLOCKS_PER_SEC);
+#endif
+}
+
+static bool bench_wanted(const char *name)
+{
+	int i;
+
+	if (!bench_only_count) return true;
+	for (i = 0; i < bench_only_count; i++) {
+		if (prefix(name, bench_only[i])) return true;
+	}
+	return false;
+}
+
+/**
+ * Stop the clock and the count of allocations, for work in a benchmark's
+ * operation which isn't part of what is measured
+ */
+void bench_pause(void)
+{
+	bench_ns += bench_now() - bench_start;
+	bench_allocs += mem_count_end();
+}
+
+void bench_resume(void)
+{
+	mem_count_begin();
+	bench_start = bench_now();
+}
+
+/**
+ * Time ops calls of op(state, i), for i from 0 to ops - 1, after one call
+ * which isn't timed to warm up.  The random numbers are seeded the same way
+ * before each benchmark so they don't depend on which others were run.
+ */
+void bench_run(const char *name, int ops, void (*op)(void *state, int i),
+	void *state)
+{
+	char full_name[80];
+	int i;
+
+	strnfmt(full_name, sizeof(full_name), "%s/%s", bench_suite, name);
+	if (!bench_wanted(full_name)) return;
+
+	Rand_state_init(BENCH_SEED);
+	op(state, 0);
+
+	bench_ns = 0;
+	bench_allocs = 0;
+	bench_resume();
+	for (i = 0; i < ops; i++) {
+		op(state, i);
+	}
+	bench_pause();
+
+	printf("{\"bench\":\"%s\",\"ops\":%d,\"ns_per_op\":%.1f,"
+		"\"allocs_per_op\":%.2f}\n", full_name, ops,
+		(double) bench_ns / ops, (double) bench_allocs / ops);
+	fflush(stdout);
+}
+
+/**
+ * Start a game with a new character on a freshly generated level
+ */
+bool bench_new_game(int depth)
+{
+	set_file_paths();
+	init_angband();
+#ifdef UNIX
+	/* Necessary for creating the randart file. */
+	create_needed_dirs();
+#endif
+
+	Rand_state_init(BENCH_SEED);
+	if (!player_make_simple(NULL, NULL, "Bench")) {
+		cleanup_angband();
+		return false;
+	}
+	dungeon_change_level(player, depth);
+	prepare_next_level(player);
+	player->upkeep->generate_level = false;
+	on_new_level();
+	return true;
+}
+
+void bench_end_game(void)
+{
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+}
+
+int main(int argc, char *argv[])
+{
+	void *state;
+	int i;
+
+	/* As the game does, for the letters outside ASCII in some names */
+	setlocale(LC_CTYPE, "");
+
+	if (getenv("FORCE_PATH") && getenv("FORCE_PATH")[0]) {
+		forcepath = 1;
+	}
+
+	bench_only = mem_zalloc(argc * sizeof(*bench_only));
+	for (i = 1; i < argc; i++) {
+		if (streq(argv[i], "-f")) {
+			forcepath = 1;
+		} else {
+			bench_only[bench_only_count++] = argv[i];
+		}
+	}
+
+	if (setup_benches(&state)) {
+		fprintf(stderr, "ERROR: %s setup failed\n", bench_suite);
+		return 1;
+	}
+
+	run_benches(state);
+
+	if (teardown_benches(state)) {
+		fprintf(stderr, "ERROR: %s teardown failed\n", bench_suite);
+		return 1;
+	}
+
+	mem_free(bench_only);
+	return 0;
+}
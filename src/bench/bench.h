@@ -0,0 +1,28 @@
+/* bench.h
+ *
+ * Framework for benchmarks of the game engine
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "h-basic.h"
+
+/* Seed for the random numbers at the start of every benchmark */
+#define BENCH_SEED 1234
+
+/* Provided by the benchmark program and expected by bench.c */
+extern const char *bench_suite;
+extern int setup_benches(void **state);
+extern void run_benches(void *state);
+extern int teardown_benches(void *state);
+
+/* Provided by bench.c for the benchmark program */
+void bench_run(const char *name, int ops, void (*op)(void *state, int i),
+	void *state);
+void bench_pause(void);
+void bench_resume(void);
+bool bench_new_game(int depth);
+void bench_end_game(void);
+
+#endif /* BENCH_H */
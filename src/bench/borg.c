@@ -0,0 +1,176 @@
+/* bench/borg.c */
+/* The borg's judgement of the danger of grids, and its flows to them */
+
+#include "angband.h"
+#include "bench.h"
+#include "borg/borg-cave.h"
+#include "borg/borg-danger.h"
+#include "borg/borg-flow-kill.h"
+#include "borg/borg-flow.h"
+#include "borg/borg-init.h"
+#include "borg/borg-inventory.h"
+#include "borg/borg-item.h"
+#include "borg/borg-power.h"
+#include "borg/borg-trait.h"
+#include "borg/borg.h"
+#include "cave.h"
+#include "monster.h"
+
+const char *bench_suite = "borg";
+
+#ifdef ALLOW_BORG
+
+/* Grids near the character to judge */
+#define BENCH_GRIDS 128
+
+/**
+ * Set up as much of the borg as judging danger needs, without the screen
+ * the borg usually learns the level from: the map and the monsters come
+ * straight from the game.
+ */
+static void bench_borg_init(void)
+{
+	char name[80];
+	int i, y, x;
+
+	borg_trait_init();
+	borg_cfg = mem_alloc(BORG_MAX_SETTINGS * sizeof(*borg_cfg));
+	for (i = 0; i < BORG_MAX_SETTINGS; i++) {
+		borg_cfg[i] = borg_settings[i].default_value;
+	}
+	borg_init_cave();
+	borg_init_flow();
+	borg_init_flow_kill();
+	borg_init_item();
+	borg_init_power();
+	borg_prepare_race_class_info();
+	borg.player = player;
+
+	borg_cheat_equip();
+	borg_cheat_inven();
+	borg_notice(false);
+	borg.c = player->grid;
+
+	for (y = 0; y < cave->height; y++) {
+		for (x = 0; x < cave->width; x++) {
+			borg_grids[y][x].feat = square(cave, loc(x, y))->feat;
+		}
+	}
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		struct monster *mon = cave_monster(cave, i);
+
+		if (!mon->race) continue;
+		/* The borg reads these names from the screen */
+		strnfmt(name, sizeof(name), "%s%s",
+			rf_has(mon->race->flags, RF_UNIQUE) ? "" : "the ",
+			mon->race->name);
+		borg_create_kill(name, mon->grid);
+	}
+
+	/* Done with the monsters, as the borg's first flow would be */
+	borg_danger_wipe = false;
+}
+
+static void bench_borg_free(void)
+{
+	borg_free_power();
+	borg_free_item();
+	borg_free_flow_kill();
+	borg_free_flow();
+	borg_free_cave();
+	mem_free(borg_cfg);
+	borg_cfg = NULL;
+	borg_trait_free();
+}
+
+int setup_benches(void **state) {
+	struct loc *grids;
+	int n = 0;
+
+	if (!bench_new_game(5)) return 1;
+	bench_borg_init();
+
+	grids = mem_zalloc(BENCH_GRIDS * sizeof(*grids));
+	while (n < BENCH_GRIDS) {
+		struct loc grid = loc_sum(player->grid,
+			loc(rand_range(-10, 10), rand_range(-10, 10)));
+
+		if (square_in_bounds(cave, grid) && square_ispassable(cave, grid))
+			grids[n++] = grid;
+	}
+	*state = grids;
+	return 0;
+}
+
+int teardown_benches(void *state) {
+	mem_free(state);
+	bench_borg_free();
+	bench_end_game();
+	return 0;
+}
+
+static void bench_borg_danger(void *state, int i) {
+	struct loc *grids = state;
+	struct loc grid = grids[i % BENCH_GRIDS];
+
+	(void) borg_danger(grid.y, grid.x, 1, true, false);
+}
+
+/**
+ * As above, but as if the monsters had moved since each grid was judged
+ */
+static void bench_borg_danger_fresh(void *state, int i) {
+	borg_danger_forget();
+	bench_borg_danger(state, i);
+}
+
+/**
+ * Spread a flow over the whole level from one of the grids, as the borg
+ * does looking for a way to somewhere it can't reach
+ */
+static void bench_borg_flow(void *state, int i) {
+	struct loc *grids = state;
+	struct loc grid = grids[i % 8];
+
+	borg_flow_clear();
+	borg_flow_enqueue_grid(grid.y, grid.x);
+	borg_flow_spread(250, false, false, false, -1, false);
+}
+
+/**
+ * As above, but as if the monsters had moved since each flow was spread
+ */
+static void bench_borg_flow_fresh(void *state, int i) {
+	borg_danger_forget();
+	bench_borg_flow(state, i);
+}
+
+/**
+ * Judge the gear, as the borg does for each swap it considers
+ */
+static void bench_borg_power(void *state, int i) {
+	(void) borg_power();
+}
+
+void run_benches(void *state) {
+	bench_run("borg_power", 2000, bench_borg_power, state);
+	bench_run("borg_danger", 20000, bench_borg_danger, state);
+	bench_run("borg_danger_fresh", 20000, bench_borg_danger_fresh, state);
+	bench_run("borg_flow_spread", 200, bench_borg_flow, state);
+	bench_run("borg_flow_spread_fresh", 200, bench_borg_flow_fresh, state);
+}
+
+#else /* ALLOW_BORG */
+
+int setup_benches(void **state) {
+	return 0;
+}
+
+int teardown_benches(void *state) {
+	return 0;
+}
+
+void run_benches(void *state) {
+}
+
+#endif /* ALLOW_BORG */
@@ -0,0 +1,79 @@
+/* bench/cave.c */
+/* Line of sight, projection paths, the view, noise and path finding */
+
+#include "angband.h"
+#include "bench.h"
+#include "cave.h"
+#include "game-world.h"
+#include "init.h"
+#include "player-path.h"
+#include "project.h"
+
+/* Number of random floor grids to use as targets */
+#define BENCH_GRIDS 256
+
+const char *bench_suite = "cave";
+
+int setup_benches(void **state) {
+	struct loc *grids;
+	int n = 0;
+
+	if (!bench_new_game(15)) return 1;
+
+	/* Let the character know the whole level, for path finding */
+	wiz_light(cave, player, false);
+
+	grids = mem_zalloc(BENCH_GRIDS * sizeof(*grids));
+	while (n < BENCH_GRIDS) {
+		struct loc grid = loc(randint0(cave->width), randint0(cave->height));
+
+		if (square_isfloor(cave, grid)) grids[n++] = grid;
+	}
+	*state = grids;
+	return 0;
+}
+
+int teardown_benches(void *state) {
+	mem_free(state);
+	bench_end_game();
+	return 0;
+}
+
+static void bench_los(void *state, int i) {
+	struct loc *grids = state;
+
+	(void) los(cave, grids[i % BENCH_GRIDS],
+		grids[(i * 7 + 3) % BENCH_GRIDS]);
+}
+
+static void bench_project_path(void *state, int i) {
+	struct loc *grids = state;
+	struct loc path[256];
+
+	(void) project_path(cave, path, z_info->max_range, player->grid,
+		grids[i % BENCH_GRIDS], 0);
+}
+
+static void bench_update_view(void *state, int i) {
+	update_view(cave, player);
+}
+
+static void bench_make_noise(void *state, int i) {
+	make_noise(player);
+}
+
+static void bench_find_path(void *state, int i) {
+	struct loc *grids = state;
+	int16_t *steps;
+
+	(void) find_path(player, player->grid, grids[i % BENCH_GRIDS], &steps);
+	mem_free(steps);
+}
+
+void run_benches(void *state) {
+	bench_run("los", 100000, bench_los, state);
+	bench_run("project_path", 100000, bench_project_path, state);
+	bench_run("update_view", 2000, bench_update_view, state);
+	bench_run("make_noise", 2000, bench_make_noise, state);
+	bench_run("find_path", 1000, bench_find_path, state);
+}
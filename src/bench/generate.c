@@ -0,0 +1,51 @@
+/* bench/generate.c */
+/* Level generation with each of the dungeon profiles */
+
+#include "angband.h"
+#include "bench.h"
+#include "cave.h"
+#include "game-input.h"
+#include "generate.h"
+#include "init.h"
+#include "player-util.h"
+
+const char *bench_suite = "generate";
+
+/* The profile to generate with */
+static const char *bench_profile;
+
+int setup_benches(void **state) {
+	return bench_new_game(1) ? 0 : 1;
+}
+
+int teardown_benches(void *state) {
+	get_string_hook = NULL;
+	bench_end_game();
+	return 0;
+}
+
+/**
+ * Answer the question debug players are asked about the profile to use
+ */
+static bool bench_get_profile(const char *prompt, char *buf, size_t len) {
+	my_strcpy(buf, bench_profile, len);
+	return true;
+}
+
+static void bench_generate(void *state, int i) {
+	dungeon_change_level(player, streq(bench_profile, "town") ? 0 : 20);
+	player->noscore |= NOSCORE_JUMPING;
+	prepare_next_level(player);
+	player->upkeep->generate_level = false;
+}
+
+void run_benches(void *state) {
+	int i;
+
+	get_string_hook = bench_get_profile;
+	for (i = 0; i < z_info->profile_max; i++) {
+		bench_profile = get_level_profile_name_from_index(i);
+		bench_run(format("cave_generate/%s", bench_profile), 20,
+			bench_generate, state);
+	}
+}
@@ -0,0 +1,106 @@
+/* bench/parse.c */
+/* Parsing the largest of the game data files */
+
+#include "angband.h"
+#include "bench.h"
+#include "datafile.h"
+#include "init.h"
+#include "mon-init.h"
+#include "obj-init.h"
+#include "test-utils.h"
+
+const char *bench_suite = "parse";
+
+/**
+ * A data file, read into memory so the benchmarks don't time the reading.
+ * Finishing some parsers also makes data another parser cleans up.
+ */
+static struct bench_datafile {
+	struct file_parser *fp;
+	struct file_parser *also;
+	const char *file;
+	char **lines;
+	int count;
+} datafiles[] = {
+	{ &artifact_parser, NULL, "artifact", NULL, 0 },
+	{ &ego_parser, NULL, "ego_item", NULL, 0 },
+	{ &monster_parser, &lore_parser, "monster", NULL, 0 },
+	{ &object_parser, NULL, "object", NULL, 0 }
+};
+
+static bool read_datafile(struct bench_datafile *df) {
+	char path[1024], buf[1024];
+	ang_file *f;
+	int size = 0;
+
+	path_build(path, sizeof(path), ANGBAND_DIR_GAMEDATA,
+		format("%s.txt", df->file));
+	f = file_open(path, MODE_READ, FTYPE_TEXT);
+	if (!f) return false;
+	while (file_getl(f, buf, sizeof(buf))) {
+		if (df->count == size) {
+			size = size ? size * 2 : 1024;
+			df->lines = mem_realloc(df->lines,
+				size * sizeof(*df->lines));
+		}
+		df->lines[df->count++] = string_make(buf);
+	}
+	return file_close(f);
+}
+
+int setup_benches(void **state) {
+	size_t i;
+
+	set_file_paths();
+	init_angband();
+	for (i = 0; i < N_ELEMENTS(datafiles); i++) {
+		if (!read_datafile(&datafiles[i])) {
+			cleanup_angband();
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int teardown_benches(void *state) {
+	size_t i;
+	int j;
+
+	for (i = 0; i < N_ELEMENTS(datafiles); i++) {
+		for (j = 0; j < datafiles[i].count; j++) {
+			string_free(datafiles[i].lines[j]);
+		}
+		mem_free(datafiles[i].lines);
+	}
+	cleanup_angband();
+	return 0;
+}
+
+/**
+ * Replace the game's copy of the data with a fresh one, as init_angband()
+ * would make it
+ */
+static void bench_parse(void *state, int i) {
+	struct bench_datafile *df = state;
+	struct parser *p;
+	int j;
+
+	if (df->also) cleanup_parser(df->also);
+	cleanup_parser(df->fp);
+	p = df->fp->init();
+	for (j = 0; j < df->count; j++) {
+		if (parser_parse(p, df->lines[j]))
+			quit_fmt("Parse error in %s line %d", df->file, j + 1);
+	}
+	if (df->fp->finish(p))
+		quit_fmt("Parser finish error in %s", df->file);
+}
+
+void run_benches(void *state) {
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(datafiles); i++) {
+		bench_run(format("parser_parse/%s", datafiles[i].file), 20,
+			bench_parse, &datafiles[i]);
+	}
+}
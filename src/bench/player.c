@@ -0,0 +1,27 @@
+/* bench/player.c */
+/* Working out the character's state */
+
+#include "angband.h"
+#include "bench.h"
+#include "player-calcs.h"
+
+const char *bench_suite = "player";
+
+int setup_benches(void **state) {
+	return bench_new_game(5) ? 0 : 1;
+}
+
+int teardown_benches(void *state) {
+	bench_end_game();
+	return 0;
+}
+
+static void bench_calc_bonuses(void *state, int i) {
+	struct player_state ps;
+
+	calc_bonuses(player, &ps, (i & 1) != 0, false);
+}
+
+void run_benches(void *state) {
+	bench_run("calc_bonuses", 20000, bench_calc_bonuses, state);
+}
@@ -0,0 +1,38 @@
+/* bench/quark.c */
+/* Adding quarks, both new strings and the few inscriptions the game repeats */
+
+#include "angband.h"
+#include "bench.h"
+#include "z-quark.h"
+
+const char *bench_suite = "quark";
+
+int setup_benches(void **state) {
+	quarks_init();
+	return 0;
+}
+
+int teardown_benches(void *state) {
+	quarks_free();
+	return 0;
+}
+
+static void bench_quark_distinct(void *state, int i) {
+	char buf[32];
+
+	strnfmt(buf, sizeof(buf), "@r%d#%d", i % 10, i);
+	(void) quark_add(buf);
+}
+
+static void bench_quark_repeated(void *state, int i) {
+	char buf[32];
+	int j = (i * 7) % 50;
+
+	strnfmt(buf, sizeof(buf), "@r%d#%d", j % 10, j);
+	(void) quark_add(buf);
+}
+
+void run_benches(void *state) {
+	bench_run("quark_add", 100000, bench_quark_distinct, state);
+	bench_run("quark_add_repeated", 100000, bench_quark_repeated, state);
+}
@@ -0,0 +1,49 @@
+/* bench/savefile.c */
+/* Saving and loading a game */
+
+#include "angband.h"
+#include "bench.h"
+#include "cave.h"
+#include "init.h"
+#include "mon-make.h"
+#include "savefile.h"
+
+#define BENCH_SAVEFILE "Bench_savefile"
+
+const char *bench_suite = "savefile";
+
+int setup_benches(void **state) {
+	if (!bench_new_game(15)) return 1;
+	return savefile_save(BENCH_SAVEFILE) ? 0 : 1;
+}
+
+int teardown_benches(void *state) {
+	file_delete(BENCH_SAVEFILE);
+	bench_end_game();
+	return 0;
+}
+
+static void bench_save(void *state, int i) {
+	if (!savefile_save(BENCH_SAVEFILE)) quit("Saving failed");
+}
+
+/**
+ * Load into a freshly initialised game, as happens when the game starts
+ */
+static void bench_load(void *state, int i) {
+	bench_pause();
+	play_again = true;
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	chunk_list_max = 0;
+	init_angband();
+	play_again = false;
+	bench_resume();
+
+	if (!savefile_load(BENCH_SAVEFILE, false)) quit("Loading failed");
+}
+
+void run_benches(void *state) {
+	bench_run("savefile_save", 200, bench_save, state);
+	bench_run("savefile_load", 20, bench_load, state);
+}
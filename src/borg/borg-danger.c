@@ -49,6 +49,183 @@ uint16_t borg_fear_monsters[AUTO_MAX_Y + 1][AUTO_MAX_X + 1];
  */
 bool borg_danger_wipe = false;
 
+/*
+ * What the danger of a grid depends on, besides the map and the monsters.
+ * The borg often changes some of it for a moment to see what difference
+ * a spell or a potion would make, so it is compared on every call.
+ */
+struct borg_danger_state {
+    int         trait[BI_MAX];
+    struct temp temp;
+    struct loc  c;
+    bool        stressed;
+    bool        new_panel;
+    int         fighting_unique;
+    bool        attacking;
+    bool        as_position;
+    bool        morgoth_position;
+    bool        create_door;
+    bool        on_glyph;
+    bool        slow_spell;
+    bool        sleep_spell;
+    bool        sleep_spell_ii;
+    bool        crush_spell;
+    bool        confuse_spell;
+    bool        fear_mon_spell;
+};
+
+/*
+ * The danger of a grid as last worked out, for one number of turns, with
+ * and without averaging.  It only counts if its stamp is the current one.
+ */
+struct borg_danger_memo {
+    uint32_t stamp;
+    int16_t  c;
+    int16_t  p;
+};
+
+static struct borg_danger_memo borg_danger_memos[AUTO_MAX_Y][AUTO_MAX_X][2];
+static struct borg_danger_state borg_danger_state_memo;
+static uint32_t borg_danger_stamp = 1;
+
+/*
+ * Whether borg_update() is part way through changing what the borg knows,
+ * and a hash of the level as it knew it after the last update
+ */
+static bool     borg_danger_updating;
+static uint32_t borg_danger_level;
+
+/*
+ * Forget the danger worked out for every grid, as something it depends on
+ * has changed
+ */
+void borg_danger_forget(void)
+{
+    if (++borg_danger_stamp == 0) {
+        memset(borg_danger_memos, 0, sizeof(borg_danger_memos));
+        borg_danger_stamp = 1;
+    }
+}
+
+/*
+ * Forget the danger worked out if the borg's state has changed since
+ */
+static void borg_danger_check_state(void)
+{
+    struct borg_danger_state state;
+
+    /* Clear the padding too, so the whole struct can be compared */
+    memset(&state, 0, sizeof(state));
+    memcpy(state.trait, borg.trait, sizeof(state.trait));
+    state.temp             = borg.temp;
+    state.c                = borg.c;
+    state.stressed         = borg.time_this_panel > 1200 || borg_t > 25000;
+    state.new_panel        = borg.time_this_panel <= 200;
+    state.fighting_unique  = borg_fighting_unique;
+    state.attacking        = borg_attacking;
+    state.as_position      = borg_as_position;
+    state.morgoth_position = borg_morgoth_position;
+    state.create_door      = borg_create_door;
+    state.on_glyph         = borg_on_glyph;
+    state.slow_spell       = borg_slow_spell;
+    state.sleep_spell      = borg_sleep_spell;
+    state.sleep_spell_ii   = borg_sleep_spell_ii;
+    state.crush_spell      = borg_crush_spell;
+    state.confuse_spell    = borg_confuse_spell;
+    state.fear_mon_spell   = borg_fear_mon_spell;
+
+    if (memcmp(&state, &borg_danger_state_memo, sizeof(state))) {
+        borg_danger_state_memo = state;
+        borg_danger_forget();
+    }
+}
+
+/*
+ * The stamp the danger worked out now is remembered under, which changes
+ * whenever anything the danger depends on does, or zero if it isn't being
+ * remembered at the moment
+ */
+uint32_t borg_danger_age(void)
+{
+    if (borg_danger_wipe || borg_tp_other_n || borg_danger_updating)
+        return 0;
+
+    borg_danger_check_state();
+    return borg_danger_stamp;
+}
+
+static uint32_t borg_danger_hash(uint32_t hash, uint32_t value)
+{
+    hash = (hash ^ value) * 16777619U;
+    return hash ^ (hash >> 15);
+}
+
+/*
+ * Hash what the borg knows of the level that the danger depends on: the
+ * map, the monsters and the fear of them
+ */
+static uint32_t borg_danger_level_hash(void)
+{
+    uint32_t hash = 2166136261U;
+    int      x, y, i;
+
+    for (y = 0; y < AUTO_MAX_Y; y++) {
+        for (x = 0; x < AUTO_MAX_X; x++) {
+            borg_grid *ag = &borg_grids[y][x];
+
+            hash = borg_danger_hash(hash, ag->feat | (ag->kill << 8)
+                | (ag->store << 16) | (ag->trap << 24) | (ag->glyph << 25)
+                | ((uint32_t) ag->web << 26));
+            hash = borg_danger_hash(hash, borg_fear_monsters[y][x]);
+        }
+    }
+    for (y = 0; y < (AUTO_MAX_Y / 11) + 1; y++) {
+        for (x = 0; x < (AUTO_MAX_X / 11) + 1; x++) {
+            hash = borg_danger_hash(hash, borg_fear_region[y][x]);
+        }
+    }
+    for (i = 1; i < borg_kills_nxt; i++) {
+        borg_kill *kill = &borg_kills[i];
+
+        hash = borg_danger_hash(hash, kill->r_idx);
+        if (!kill->r_idx)
+            continue;
+        hash = borg_danger_hash(hash, kill->pos.x | (kill->pos.y << 16));
+        hash = borg_danger_hash(hash, kill->known | (kill->awake << 1)
+            | (kill->confused << 2) | (kill->afraid << 3)
+            | (kill->stunned << 4) | (kill->speed << 8)
+            | ((uint32_t) kill->ranged_attack << 16));
+        hash = borg_danger_hash(hash, (uint16_t) kill->power
+            | ((uint32_t) (uint16_t) kill->injury << 16));
+        hash = borg_danger_hash(hash, (uint16_t) kill->level);
+    }
+    hash = borg_danger_hash(hash, borg_items[INVEN_LIGHT].timeout);
+    return hash;
+}
+
+/*
+ * borg_update() is about to change what the borg knows
+ */
+void borg_danger_begin_update(void)
+{
+    borg_danger_updating = true;
+}
+
+/*
+ * borg_update() has finished, so forget the danger worked out before it
+ * unless the level looks just as it did after the last one
+ */
+void borg_danger_end_update(void)
+{
+    uint32_t level = borg_danger_level_hash();
+
+    borg_danger_updating = false;
+    if (level != borg_danger_level) {
+        borg_danger_level = level;
+        borg_danger_forget();
+    }
+}
+
 /*
  * Calculate base danger from a monster's physical attacks
  *
@@ -2806,15 +2983,28 @@ int borg_danger_one_kill(
  * of invisible monsters and things of that nature.
  *
  * Generally bool Average is true.
+ *
+ * The danger of each grid is remembered until the borg or the monsters
+ * change, since it is asked for the same grids many times in a turn.
  */
 int borg_danger(int y, int x, int c, bool average, bool full_damage)
 {
     int i, p = 0;
 
+    struct borg_danger_memo *memo = NULL;
+
     struct loc l = loc(x, y);
     if (!square_in_bounds(cave, l))
         return 2000;
 
+    /* Use the danger already worked out, unless the monsters have changed
+     * since or some are being left out */
+    if (borg_danger_age()) {
+        memo = &borg_danger_memos[y][x][average ? 1 : 0];
+        if (memo->stamp == borg_danger_stamp && memo->c == c)
+            return memo->p;
+    }
+
     /* Base danger (from regional fear) but not within a vault.  Cheating the
      * floor grid */
     if (!square_isvault(cave, l) && borg.trait[BI_CDEPTH] <= 80) {
@@ -2847,8 +3037,18 @@ int borg_danger(int y, int x, int c, bool average, bool full_damage)
         p += borg_danger_one_kill(y, x, c, i, average, full_damage);
     }
 
+    if (p > 2000)
+        p = 2000;
+
+    /* Remember it */
+    if (memo) {
+        memo->stamp = borg_danger_stamp;
+        memo->c     = c;
+        memo->p     = p;
+    }
+
     /* Return the danger */
-    return (p > 2000 ? 2000 : p);
+    return p;
 }
 
 #endif
@@ -76,6 +76,22 @@ extern uint16_t borg_fear_monsters[AUTO_MAX_Y + 1][AUTO_MAX_X + 1];
  */
 extern bool borg_danger_wipe;
 
+/*
+ * Forget the danger worked out for each grid
+ */
+extern void borg_danger_forget(void);
+
+/*
+ * The stamp of the danger worked out now, or zero if it isn't kept
+ */
+extern uint32_t borg_danger_age(void);
+
+/*
+ * Bracket borg_update(), which changes what the danger depends on
+ */
+extern void borg_danger_begin_update(void);
+extern void borg_danger_end_update(void);
+
 /*
  * Calculate danger to a grid from a monster
  */
@@ -5228,8 +5228,10 @@ bool borg_attack(bool boosted_bravery)
         /* Sometimes the borg can lose a monster index in the grid if there are
          * lots of monsters on screen.  If he does lose one, reinject the index
          * here. */
-        if (!ag->kill)
+        if (!ag->kill) {
             borg_grids[kill->pos.y][kill->pos.x].kill = i;
+            borg_danger_forget();
+        }
 
         /* Save the location (careful) */
         borg_temp_x[borg_temp_n] = kill->pos.x;
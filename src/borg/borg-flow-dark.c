@@ -434,6 +434,9 @@ static void borg_flow_border(int y1, int x1, int y2, int x2, bool stop)
 {
     int x, y;
 
+    /* Flows spread inside the edges or before them don't hold any more */
+    borg_flow_forget();
+
     /* Scan west/east edges */
     for (y = y1; y <= y2; y++) {
         /* Avoid/Clear west edge */
@@ -39,6 +39,7 @@
 #include "borg-item-use.h"
 #include "borg-item-val.h"
 #include "borg-magic.h"
+#include "borg-observe.h"
 #include "borg-projection.h"
 #include "borg-trait.h"
 #include "borg-update.h"
@@ -916,7 +917,7 @@ static unsigned int borg_guess_race(
      * the sake of speed
      */
     struct monster *m_ptr;
-    m_ptr = square_monster(cave, loc(x, y));
+    m_ptr = borg_observe_monster(loc(x, y));
 
     if (!m_ptr)
         return 0;
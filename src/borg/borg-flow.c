@@ -63,6 +63,44 @@ borg_data *borg_data_hard; /* Constant "hard" data */
 borg_data *borg_data_know; /* Current "know" flags */
 borg_data *borg_data_icky; /* Current "icky" flags */
 
+/*
+ * Flows already spread, so that the same flow asked for again before
+ * anything it depends on has changed is copied instead of spread again
+ */
+#define BORG_FLOW_MAPS 8
+
+/*
+ * The way a flow is spread from its grids, other than what borg_danger_age()
+ * covers
+ */
+struct borg_flow_way {
+    int      depth;
+    int      origin_y;
+    int      origin_x;
+    uint32_t flags; /* The spread's flags, and the borg's modes */
+    int      avoidance;
+    int      shop;
+};
+
+struct borg_flow_map {
+    uint32_t   age; /* borg_danger_age() when it was spread, zero if unused */
+    uint32_t   key; /* Hash of the grids and the way, to rule out most */
+    struct borg_flow_way way; /* The way it was spread */
+    int        grid_count; /* The grids it was spread from */
+    uint8_t   *grid_y;
+    uint8_t   *grid_x;
+    borg_data *cost; /* The "cost" data it spread */
+};
+
+static struct borg_flow_map borg_flow_maps[BORG_FLOW_MAPS];
+static int                  borg_flow_map_next;
+
+/*
+ * Whether the "cost" data holds nothing but the grids enqueued since it was
+ * cleared
+ */
+static bool borg_flow_fresh;
+
 /*
  * Maintain a temporary set of grids
  * Used to store monster info.
@@ -166,6 +204,19 @@ bool borg_can_dig(bool check_fail, uint8_t feat)
     return false;
 }
 
+/*
+ * Forget the flows already spread, as the "know" or "icky" flags have been
+ * changed behind their back
+ */
+void borg_flow_forget(void)
+{
+    int i;
+
+    for (i = 0; i < BORG_FLOW_MAPS; i++) {
+        borg_flow_maps[i].age = 0;
+    }
+}
+
 /*
  * Clear the "flow" information
  */
@@ -182,13 +233,85 @@ void borg_flow_clear(void)
         /* Wipe the "icky" flags */
         memset(borg_data_icky, 0, sizeof(borg_data));
 
+        /* Forget the danger of each grid */
+        borg_danger_forget();
+
         /* Wipe complete */
         borg_danger_wipe = false;
     }
 
     /* Start over */
-    flow_head = 0;
-    flow_tail = 0;
+    flow_head       = 0;
+    flow_tail       = 0;
+    borg_flow_fresh = true;
+}
+
+static uint32_t borg_flow_hash(uint32_t hash, uint32_t value)
+{
+    hash = (hash ^ value) * 16777619U;
+    return hash ^ (hash >> 15);
+}
+
+/*
+ * Note everything the spread of a flow depends on, other than the grids in
+ * the queue and what borg_danger_age() covers
+ */
+static void borg_flow_way_get(struct borg_flow_way *way, int depth,
+    bool optimize, bool avoid, bool tunneling, int origin_y, int origin_x,
+    bool sneak)
+{
+    way->depth     = depth;
+    way->origin_y  = origin_y;
+    way->origin_x  = origin_x;
+    way->flags     = optimize | (avoid << 1) | (tunneling << 2) | (sneak << 3)
+        | (borg_desperate << 4) | (borg.lunal_mode << 5)
+        | (borg.munchkin_mode << 6) | (borg_digging << 7)
+        | (scaryguy_on_level << 8) | ((unique_on_level != 0) << 9)
+        | (vault_on_level << 10) | (borg.goal.ignoring << 11)
+        | ((borg_t - borg_began > 5000) << 12);
+    way->avoidance = avoidance;
+    way->shop      = borg.goal.shop;
+}
+
+/*
+ * Hash the grids in the queue and the way a flow is spread from them
+ */
+static uint32_t borg_flow_key(const struct borg_flow_way *way)
+{
+    uint32_t hash = 2166136261U;
+    int      i;
+
+    for (i = flow_tail; i != flow_head; i = (i + 1) % AUTO_FLOW_MAX) {
+        hash = borg_flow_hash(hash, borg_flow_x[i] | (borg_flow_y[i] << 8));
+    }
+    hash = borg_flow_hash(hash, way->depth | (way->origin_y << 8)
+        | (way->origin_x << 16));
+    hash = borg_flow_hash(hash, way->flags);
+    hash = borg_flow_hash(hash, (uint16_t) way->avoidance
+        | ((uint32_t) (uint16_t) way->shop << 16));
+    return hash;
+}
+
+/*
+ * Check that a kept flow was spread from exactly the grids in the queue, in
+ * exactly the same way
+ */
+static bool borg_flow_map_same(
+    const struct borg_flow_map *map, const struct borg_flow_way *way)
+{
+    int i, n = 0;
+
+    if (map->way.depth != way->depth || map->way.origin_y != way->origin_y
+        || map->way.origin_x != way->origin_x || map->way.flags != way->flags
+        || map->way.avoidance != way->avoidance || map->way.shop != way->shop)
+        return false;
+
+    for (i = flow_tail; i != flow_head; i = (i + 1) % AUTO_FLOW_MAX, n++) {
+        if (n == map->grid_count || map->grid_y[n] != borg_flow_y[i]
+            || map->grid_x[n] != borg_flow_x[i])
+            return false;
+    }
+    return n == map->grid_count;
 }
 
 /*
@@ -257,6 +380,9 @@ void borg_flow_clear(void)
  *
  * "Sneak" will have the borg avoid grids which are adjacent to a monster.
  *
+ * The last few flows spread from freshly cleared grids are kept, and a flow
+ * spread again from the same grids in the same way is copied from them if
+ * neither the map, the monsters nor the borg have changed since.
  */
 void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunneling,
     int stair_idx, bool sneak)
@@ -271,6 +397,9 @@ void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunneling,
     bool bad_sneak = false;
     int  origin_y, origin_x;
     bool twitchy = false;
+    uint32_t age = 0, key;
+    struct borg_flow_way way;
+    struct borg_flow_map *keep = NULL;
 
     /* Default starting points */
     origin_y = borg.c.y;
@@ -288,6 +417,37 @@ void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunneling,
         optimize = false;
     }
 
+    /* Copy the same flow if it has already been spread */
+    if (borg_flow_fresh)
+        age = borg_danger_age();
+    borg_flow_fresh = false;
+    if (age) {
+        borg_flow_way_get(&way, depth, optimize, avoid, tunneling, origin_y,
+            origin_x, sneak);
+        key = borg_flow_key(&way);
+        for (i = 0; i < BORG_FLOW_MAPS; i++) {
+            struct borg_flow_map *map = &borg_flow_maps[i];
+
+            if (map->age == age && map->key == key
+                && borg_flow_map_same(map, &way)) {
+                memcpy(borg_data_cost, map->cost, sizeof(borg_data));
+                flow_head = flow_tail = 0;
+                return;
+            }
+        }
+
+        /* Note the grids and the way, before spreading uses up the queue */
+        keep       = &borg_flow_maps[borg_flow_map_next];
+        keep->age  = 0;
+        keep->key  = key;
+        keep->way  = way;
+        keep->grid_count = 0;
+        for (i = flow_tail; i != flow_head; i = (i + 1) % AUTO_FLOW_MAX) {
+            keep->grid_y[keep->grid_count]   = borg_flow_y[i];
+            keep->grid_x[keep->grid_count++] = borg_flow_x[i];
+        }
+    }
+
     /* Now process the queue */
     while (flow_head != flow_tail) {
         /* Extract the next entry */
@@ -502,6 +662,13 @@ void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunneling,
         }
     }
 
+    /* Keep the flow, unless something changed while spreading it */
+    if (keep && age == borg_danger_age()) {
+        memcpy(keep->cost, borg_data_cost, sizeof(borg_data));
+        keep->age          = age;
+        borg_flow_map_next = (borg_flow_map_next + 1) % BORG_FLOW_MAPS;
+    }
+
     /* Forget the flow info */
     flow_head = flow_tail = 0;
 }
@@ -1234,7 +1401,7 @@ void borg_free_track(struct borg_track *track)
 
 void borg_init_flow(void)
 {
-    int x, y;
+    int i, x, y;
 
     /*** Grid data ***/
 
@@ -1253,6 +1420,14 @@ void borg_init_flow(void)
     /* Allocate */
     borg_data_icky = mem_zalloc(sizeof(borg_data));
 
+    /* Allocate the flows kept */
+    for (i = 0; i < BORG_FLOW_MAPS; i++) {
+        borg_flow_maps[i].age    = 0;
+        borg_flow_maps[i].grid_y = mem_zalloc(AUTO_FLOW_MAX);
+        borg_flow_maps[i].grid_x = mem_zalloc(AUTO_FLOW_MAX);
+        borg_flow_maps[i].cost   = mem_zalloc(sizeof(borg_data));
+    }
+
     /* Prepare "borg_data_hard" */
     for (y = 0; y < AUTO_MAX_Y; y++) {
         for (x = 0; x < AUTO_MAX_X; x++) {
@@ -1277,6 +1452,8 @@ void borg_init_flow(void)
 
 void borg_free_flow(void)
 {
+    int i;
+
     borg_free_flow_misc();
     borg_free_flow_glyph();
     borg_free_flow_stairs();
@@ -1285,6 +1462,16 @@ void borg_free_flow(void)
     borg_free_track(&track_door);
     borg_free_track(&track_step);
 
+    for (i = 0; i < BORG_FLOW_MAPS; i++) {
+        mem_free(borg_flow_maps[i].cost);
+        borg_flow_maps[i].cost = NULL;
+        mem_free(borg_flow_maps[i].grid_x);
+        borg_flow_maps[i].grid_x = NULL;
+        mem_free(borg_flow_maps[i].grid_y);
+        borg_flow_maps[i].grid_y = NULL;
+        borg_flow_maps[i].age    = 0;
+    }
+
     mem_free(borg_data_icky);
     borg_data_icky = NULL;
     mem_free(borg_data_know);
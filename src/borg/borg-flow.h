@@ -141,6 +141,11 @@ extern const int16_t borg_ddy_ddd[24];
  */
 extern bool borg_can_dig(bool check_fail, uint8_t feat);
 
+/*
+ * Forget the flows already spread
+ */
+extern void borg_flow_forget(void);
+
 /*
  * Clear the "flow" information
  */
@@ -22,15 +22,28 @@
 #ifdef ALLOW_BORG
 #include "borg-formulas.h"
 #include "borg-io.h"
+#include "borg.h"
+
+/* an instruction of a compiled formula */
+struct borg_code {
+    int     op;
+    int32_t arg;
+};
 
 struct borg_calculation {
     struct borg_array *token_array;
     int32_t            max_depth;
+    struct borg_code  *code; /* NULL if the formula couldn't be compiled */
+    int                code_count;
 };
 
 /* array of mathematic formulas */
 struct borg_array calculations;
 
+/* the stack compiled formulas are worked out on */
+static int32_t *calc_stack;
+static int      calc_stack_size;
+
 /* types of tokens that can be in a calculation */
 enum token_type {
     TOK_NONE,
@@ -53,6 +66,33 @@ enum token_type {
 
 #define OP_LEVELS 4
 
+/*
+ * instructions of a compiled formula.  The values push their number, the
+ * operators pop two and push the result.
+ */
+enum calc_op {
+    CALC_NUMBER,
+    CALC_TRAIT,
+    CALC_CONFIG,
+    CALC_ACTIVATION,
+    CALC_HAS,
+    CALC_CLASS,
+    CALC_RANGE_INDEX,
+    CALC_NOT,
+    /* operators, in the same order as their tokens */
+    CALC_MINUS,
+    CALC_PLUS,
+    CALC_MULT,
+    CALC_DIV,
+    CALC_AND,
+    CALC_OR,
+    CALC_EQUALS,
+    CALC_LT,
+    CALC_GT,
+    CALC_LE,
+    CALC_GE,
+};
+
 /* a single token in the calculation */
 struct token {
     enum token_type type;
@@ -546,10 +586,234 @@ static void calc_free(struct borg_calculation *calc)
         mem_free(calc->token_array);
         calc->token_array = NULL;
     }
+    mem_free(calc->code);
+    calc->code = NULL;
     mem_free(calc);
     calc = NULL;
 }
 
+/*
+ * Work out a compiled formula, or part of one
+ */
+static int32_t calculate_code(
+    const struct borg_code *code, int count, int range_index)
+{
+    const struct borg_code *end = code + count;
+    int32_t                *sp  = calc_stack;
+
+    for (; code < end; code++) {
+        switch (code->op) {
+        case CALC_NUMBER:
+            *sp++ = code->arg;
+            break;
+        case CALC_TRAIT:
+            *sp++ = borg.trait[code->arg];
+            break;
+        case CALC_CONFIG:
+            *sp++ = borg_cfg[code->arg];
+            break;
+        case CALC_ACTIVATION:
+            *sp++ = borg.activation[code->arg];
+            break;
+        case CALC_HAS:
+            *sp++ = borg.has[code->arg];
+            break;
+        case CALC_CLASS:
+            *sp++ = borg.trait[BI_CLASS] == code->arg;
+            break;
+        case CALC_RANGE_INDEX:
+            *sp++ = range_index;
+            break;
+        case CALC_NOT:
+            sp[-1] = !sp[-1];
+            break;
+        case CALC_MINUS:
+            sp--;
+            sp[-1] = sp[-1] - sp[0];
+            break;
+        case CALC_PLUS:
+            sp--;
+            sp[-1] = sp[-1] + sp[0];
+            break;
+        case CALC_MULT:
+            sp--;
+            sp[-1] = sp[-1] * sp[0];
+            break;
+        case CALC_DIV:
+            sp--;
+            sp[-1] = sp[-1] / sp[0];
+            break;
+        case CALC_AND:
+            sp--;
+            sp[-1] = sp[-1] && sp[0];
+            break;
+        case CALC_OR:
+            sp--;
+            sp[-1] = sp[-1] || sp[0];
+            break;
+        case CALC_EQUALS:
+            sp--;
+            sp[-1] = sp[-1] == sp[0];
+            break;
+        case CALC_LT:
+            sp--;
+            sp[-1] = sp[-1] < sp[0];
+            break;
+        case CALC_GT:
+            sp--;
+            sp[-1] = sp[-1] > sp[0];
+            break;
+        case CALC_LE:
+            sp--;
+            sp[-1] = sp[-1] <= sp[0];
+            break;
+        case CALC_GE:
+            sp--;
+            sp[-1] = sp[-1] >= sp[0];
+            break;
+        }
+    }
+    return calc_stack[0];
+}
+
+/*
+ * add an instruction to a compiled formula
+ */
+static void emit_code(struct borg_calculation *f, int op, int32_t arg)
+{
+    f->code[f->code_count].op  = op;
+    f->code[f->code_count].arg = arg;
+    f->code_count++;
+}
+
+/*
+ * compile the value or number of a token
+ */
+static void compile_operand(struct borg_calculation *f, struct token *tok)
+{
+    struct value_sec *v;
+
+    if (tok->type == TOK_NUMBER) {
+        int32_t n = *((int32_t *)tok->token);
+        emit_code(f, CALC_NUMBER, tok->not ? !n : n);
+        return;
+    }
+
+    v = (struct value_sec *)tok->token;
+    switch (v->type) {
+    case VT_ACTIVATION:
+        emit_code(f, CALC_ACTIVATION, v->index);
+        break;
+    case VT_TRAIT:
+        emit_code(f, CALC_TRAIT, v->index);
+        break;
+    case VT_CONFIG:
+        emit_code(f, CALC_CONFIG, v->index);
+        break;
+    case VT_CLASS:
+        emit_code(f, CALC_CLASS, v->index);
+        break;
+    case VT_RANGE_INDEX:
+        emit_code(f, CALC_RANGE_INDEX, 0);
+        break;
+    default:
+        emit_code(f, CALC_HAS, v->index);
+        break;
+    }
+    if (tok->not )
+        emit_code(f, CALC_NOT, 0);
+}
+
+/*
+ * compile an operator, working it out now if both sides are numbers
+ */
+static void compile_operator(struct borg_calculation *f, struct token *tok)
+{
+    struct borg_code *left  = &f->code[f->code_count - 2];
+    struct borg_code *right = &f->code[f->code_count - 1];
+
+    emit_code(f, CALC_MINUS + (tok->type - TOK_MINUS), 0);
+
+    /* leave dividing by zero to happen as it would have */
+    if (left->op != CALC_NUMBER || right->op != CALC_NUMBER
+        || (tok->type == TOK_DIV && !right->arg))
+        return;
+
+    left->arg     = calculate_code(left, 3, 0);
+    f->code_count -= 2;
+}
+
+/*
+ * Compile a formula for a given parenthesis level, in the same order
+ *   calculate_value_from_formula_depth() works it out.
+ * returns true if the formula isn't one that can be compiled
+ */
+static bool compile_formula_depth(
+    struct borg_calculation *f, int *i, int pdepth)
+{
+    struct borg_array *a          = f->token_array;
+    struct token      *left_token = a->items[*i];
+
+    /* the value on the left */
+    if (left_token->pdepth > pdepth) {
+        if (compile_formula_depth(f, i, pdepth + 1))
+            return true;
+    } else
+        compile_operand(f, left_token);
+
+    if ((*i) + 1 >= a->count)
+        return false;
+
+    struct token *operation = a->items[(*i) + 1];
+    if (operation->pdepth < pdepth)
+        return false;
+    ++(*i);
+
+    /* the value on the right */
+    struct token *right_token = a->items[++(*i)];
+    if (right_token->pdepth > pdepth) {
+        if (compile_formula_depth(f, i, pdepth + 1))
+            return true;
+    } else
+        compile_operand(f, right_token);
+
+    if (!is_operator(operation->type))
+        return true;
+    compile_operator(f, operation);
+
+    if ((*i) + 1 >= a->count)
+        return false;
+    struct token *next_token = a->items[(*i) + 1];
+    return next_token->pdepth == pdepth;
+}
+
+/*
+ * compile a formula into instructions for a stack, so working it out
+ * doesn't need to walk the tokens.  Formulas that can't be compiled are
+ * left to the tokens.
+ */
+static void compile_calculation(struct borg_calculation *f)
+{
+    int i = 0;
+
+    /* a value and its "not" for each token is as long as it can get */
+    f->code       = mem_zalloc(2 * f->token_array->count * sizeof(*f->code));
+    f->code_count = 0;
+
+    /* the stack holds at most one number for each token */
+    if (calc_stack_size < f->token_array->count) {
+        calc_stack_size = f->token_array->count;
+        calc_stack
+            = mem_realloc(calc_stack, calc_stack_size * sizeof(*calc_stack));
+    }
+
+    if (compile_formula_depth(f, &i, 0)) {
+        mem_free(f->code);
+        f->code       = NULL;
+        f->code_count = 0;
+    }
+}
+
 /*
  * parse the formula and add it to the formula list
  */
@@ -561,6 +825,7 @@ int parse_calculation_line(char *line, const char *full_line)
         f = NULL;
         return -1;
     }
+    compile_calculation(f);
 
     int i = borg_array_add(&calculations, f);
     if (i == -1)
@@ -678,6 +943,9 @@ int32_t borg_calculate_dynamic(int formula, int range_index)
     int                      i = 0;
     struct borg_calculation *f = calculations.items[formula];
 
+    if (f->code && borg_cfg[BORG_COMPILES_FORMULAS])
+        return calculate_code(f->code, f->code_count, range_index);
+
     return calculate_value_from_formula_depth(
         f->token_array, &i, 0, range_index);
 }
@@ -692,6 +960,9 @@ void calculations_free(void)
         calculations.items[i] = NULL;
     }
     calculations.count = 0;
+    mem_free(calc_stack);
+    calc_stack      = NULL;
+    calc_stack_size = 0;
 }
 
 #endif
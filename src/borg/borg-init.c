@@ -68,6 +68,7 @@ struct borg_setting borg_settings[] = {
     { "borg_kills_uniques", 'b', false }, 
     { "borg_uses_swaps", 'b', true },
     { "borg_uses_dynamic_calcs", 'b', false },
+    { "borg_compiles_formulas", 'b', true },
     { "borg_stop_dlevel", 'i', 128 }, 
     { "borg_stop_clevel", 'i', 51 },
     { "borg_no_deeper", 'i', 127 }, 
@@ -522,6 +523,7 @@ void borg_init(void)
     borg_init_flow_kill();
 
     borg_init_item();
+    borg_init_power();
     borg_init_store();
     /*** Object/Monster tracking ***/
     borg_init_update();
@@ -605,6 +607,7 @@ void borg_free(void)
     event_remove_handler(EVENT_LEAVE_GAME, borg_leave_game, NULL);
     borg_free_update();
     borg_free_item();
+    borg_free_power();
     borg_free_store();
 
     borg_free_flow_kill();
@@ -0,0 +1,99 @@
+/**
+ * \file borg-observe.c
+ * \brief What the borg sees of a grid, read from the character's knowledge
+ *
+ * The borg used to learn each grid through map_info(), which works out how
+ * to draw it: it memorizes the grid for the display and, when the character
+ * is hallucinating, draws random fakes with the game's random numbers (so a
+ * borg game could not be replayed).  This reads the same things straight from
+ * what the character knows, and changes nothing.
+ *
+ * Copyright (c) 2026 Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband License":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "borg-observe.h"
+
+#ifdef ALLOW_BORG
+
+#include "../monster.h"
+#include "../mon-util.h"
+#include "../obj-ignore.h"
+#include "../obj-pile.h"
+#include "../player-calcs.h"
+
+/*
+ * How a grid is lit, following map_info()
+ */
+static enum grid_light_level borg_observe_light(struct loc grid, bool in_view)
+{
+    bool lit;
+
+    if (!in_view)
+        return LIGHTING_LIT;
+
+    lit = square_islit(cave, grid);
+    if (sqinfo_has(square(cave, grid)->info, SQUARE_CLOSE_PLAYER)) {
+        if (player_has(player, PF_UNLIGHT) && player->state.cur_light <= 1)
+            return lit ? LIGHTING_LOS : LIGHTING_DARK;
+        if (lit)
+            return OPT(player, view_yellow_light) ? LIGHTING_TORCH
+                                                  : LIGHTING_LOS;
+        return LIGHTING_LIT;
+    }
+    return lit ? LIGHTING_LOS : LIGHTING_LIT;
+}
+
+/*
+ * The monster the character can see in a grid, if any
+ */
+struct monster *borg_observe_monster(struct loc grid)
+{
+    struct monster *mon = square_monster(cave, grid);
+
+    if (!mon || !monster_is_visible(mon))
+        return NULL;
+    return mon;
+}
+
+/*
+ * Look at a grid, as map_info() would but without touching the game.
+ *
+ * Hallucination is left out: the borg ignores what it sees while
+ * hallucinating anyway.
+ */
+void borg_observe_grid(struct loc grid, struct borg_seen *seen)
+{
+    struct object *obj;
+
+    seen->feat = square(player->cave, grid)->feat;
+    if (f_info[seen->feat].mimic)
+        seen->feat = f_info[seen->feat].mimic->fidx;
+
+    seen->in_view   = square_isseen(cave, grid);
+    seen->is_player = square(cave, grid)->mon < 0;
+    seen->lighting  = borg_observe_light(grid, seen->in_view);
+    seen->mon       = seen->is_player ? NULL : borg_observe_monster(grid);
+
+    seen->first_kind = NULL;
+    for (obj = square_object(player->cave, grid); obj; obj = obj->next) {
+        if (obj->kind == unknown_gold_kind || obj->kind == unknown_item_kind)
+            continue;
+        if (ignore_known_item_ok(player, obj))
+            continue;
+        seen->first_kind = obj->kind;
+        break;
+    }
+}
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * \file borg-observe.h
+ * \brief What the borg sees of a grid, read from the character's knowledge
+ *
+ * Copyright (c) 2026 Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband License":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_BORG_OBSERVE_H
+#define INCLUDED_BORG_OBSERVE_H
+
+/*
+ * must be included before ALLOW_BORG to avoid empty compilation unit
+ */
+#include "../angband.h"
+
+#ifdef ALLOW_BORG
+
+#include "../cave.h"
+
+/*
+ * One grid as the character knows it
+ */
+struct borg_seen {
+    int                   feat; /* Known feature, mimics resolved */
+    enum grid_light_level lighting; /* How the grid is lit */
+    bool                  in_view; /* The character can see the grid */
+    bool                  is_player; /* The character is in the grid */
+    struct monster       *mon; /* A visible monster in the grid */
+    struct object_kind   *first_kind; /* First known, unignored object */
+};
+
+/*
+ * Look at a grid, as map_info() would but without touching the game
+ */
+extern void borg_observe_grid(struct loc grid, struct borg_seen *seen);
+
+/*
+ * The monster the character can see in a grid, if any
+ */
+extern struct monster *borg_observe_monster(struct loc grid);
+
+#endif
+#endif
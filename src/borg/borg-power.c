@@ -1881,9 +1881,175 @@ static int32_t borg_power_inventory(void)
 }
 
 /*
- * Calculate the "power" of the Borg
+ * What borg_power() reads of an item
  */
-int32_t borg_power(void)
+struct borg_power_gear {
+    uint32_t kind;
+    int      activ_idx;
+    int16_t  to_h;
+    int16_t  to_d;
+    int16_t  weight;
+    uint8_t  iqty;
+    uint8_t  tval;
+    uint8_t  sval;
+    uint8_t  dd;
+    uint8_t  ds;
+    uint8_t  art_idx;
+    uint8_t  ego_idx;
+    bool     aware;
+    bool     ident;
+};
+
+/*
+ * What borg_power() reads besides the traits, the gear and the settings
+ */
+struct borg_power_extra {
+    int          ready_morgoth;
+    int          numb_live_unique;
+    unsigned int first_living_unique;
+    int          depth_hunted_unique;
+    int16_t      num_ezheal;
+    int16_t      num_ezheal_true;
+    int16_t      num_life;
+    int16_t      num_life_true;
+    int16_t      amt_book[9];
+    int16_t      amt_statgain[STAT_MAX];
+    bool         need_statgain[STAT_MAX];
+    bool         just_arrived; /* borg_restock() asks at depth 100 */
+};
+
+/*
+ * The power of the gear judged lately.  borg_best_stuff() and the stores
+ * judge the same swaps each time the borg thinks, so each judgement is kept
+ * with everything it was worked out from: the traits borg_notice() made of
+ * the gear, the gear itself (the kinds carried and the activations follow
+ * from it), the spells known, the settings and what is known of the
+ * uniques.  An entry is picked by the gear, which is what differs between
+ * swaps, and only used if all of it is the same.
+ *
+ * From depth 82 borg_prepared() counts the potions at home itself, which
+ * matters beyond the answer, so a judgement which got that deep is worked
+ * out again rather than remembered.
+ */
+#define BORG_POWER_MEMO 64
+
+struct borg_power_memo {
+    bool                     used;
+    bool                     counted_home; /* borg_prepared() got to 82 */
+    int32_t                  value;
+    int                      ready_morgoth; /* as borg_prepared() left it */
+    int                     *trait;
+    int                     *cfg;
+    uint8_t                 *spells;
+    struct borg_power_gear  *gear;
+    struct borg_power_extra  extra;
+};
+
+static struct borg_power_memo *borg_power_memos;
+static struct borg_power_extra borg_power_extra_now;
+static struct borg_power_gear *borg_power_gear_now;
+static size_t                  borg_power_gear_size;
+
+/*
+ * Note the gear and the rest of what the power is worked out from besides
+ * the traits, settings and spells, and return the sum which picks the entry
+ */
+static uint32_t borg_power_note(void)
+{
+    struct borg_power_extra *extra = &borg_power_extra_now;
+    uint32_t                 sum   = 0;
+    int                      i;
+
+    /* Clear the padding too, as the notes are compared whole */
+    memset(extra, 0, sizeof(*extra));
+    extra->ready_morgoth       = borg.ready_morgoth;
+    extra->numb_live_unique    = borg_numb_live_unique;
+    extra->first_living_unique = borg_first_living_unique;
+    extra->depth_hunted_unique = borg_depth_hunted_unique;
+    extra->num_ezheal          = num_ezheal;
+    extra->num_ezheal_true     = num_ezheal_true;
+    extra->num_life            = num_life;
+    extra->num_life_true       = num_life_true;
+    memcpy(extra->amt_book, borg.amt_book, sizeof(extra->amt_book));
+    memcpy(extra->amt_statgain, borg.amt_statgain,
+        sizeof(extra->amt_statgain));
+    memcpy(extra->need_statgain, borg.need_statgain,
+        sizeof(extra->need_statgain));
+    extra->just_arrived = borg_t - borg_began < 10;
+
+    memset(borg_power_gear_now, 0, borg_power_gear_size);
+    for (i = 0; i < INVEN_TOTAL; i++) {
+        borg_item              *item = &borg_items[i];
+        struct borg_power_gear *gear = &borg_power_gear_now[i];
+
+        if (!item->iqty)
+            continue;
+        gear->kind      = item->kind;
+        gear->activ_idx = item->activ_idx;
+        gear->to_h      = item->to_h;
+        gear->to_d      = item->to_d;
+        gear->weight    = item->weight;
+        gear->iqty      = item->iqty;
+        gear->tval      = item->tval;
+        gear->sval      = item->sval;
+        gear->dd        = item->dd;
+        gear->ds        = item->ds;
+        gear->art_idx   = item->art_idx;
+        gear->ego_idx   = item->ego_idx;
+        gear->aware     = item->aware;
+        gear->ident     = item->ident;
+
+        sum = sum * 31 + gear->kind * 7 + gear->iqty + gear->to_h * 3
+              + gear->to_d * 5 + gear->ego_idx + gear->art_idx * 11;
+    }
+
+    return sum;
+}
+
+/*
+ * Is the entry worked out from what the borg has now?
+ */
+static bool borg_power_same(const struct borg_power_memo *memo)
+{
+    int i;
+
+    if (!memo->used || memo->counted_home)
+        return false;
+    if (memcmp(memo->gear, borg_power_gear_now, borg_power_gear_size)
+        || memcmp(&memo->extra, &borg_power_extra_now, sizeof(memo->extra)))
+        return false;
+    if (memcmp(memo->trait, borg.trait, BI_MAX * sizeof(int))
+        || memcmp(memo->cfg, borg_cfg, BORG_MAX_SETTINGS * sizeof(int)))
+        return false;
+    for (i = 0; borg_magics && i < player->class->magic.total_spells; i++)
+        if (memo->spells[i] != borg_magics[i].status)
+            return false;
+
+    return true;
+}
+
+/*
+ * Keep what the power was just worked out from in the entry
+ */
+static void borg_power_keep(struct borg_power_memo *memo)
+{
+    int i;
+
+    memcpy(memo->gear, borg_power_gear_now, borg_power_gear_size);
+    memcpy(&memo->extra, &borg_power_extra_now, sizeof(memo->extra));
+    memcpy(memo->trait, borg.trait, BI_MAX * sizeof(int));
+    memcpy(memo->cfg, borg_cfg, BORG_MAX_SETTINGS * sizeof(int));
+    for (i = 0; borg_magics && i < player->class->magic.total_spells; i++)
+        memo->spells[i] = borg_magics[i].status;
+    memo->used = true;
+}
+
+/*
+ * The power of the gear itself and of being prepared for the depths; notes
+ * whether borg_prepared() was asked about a depth where it counts the
+ * potions at home
+ */
+static int32_t borg_power_aux(bool *counted_home)
 {
     int     i = 1;
     int32_t value = 0L;
@@ -1907,6 +2073,33 @@ int32_t borg_power(void)
             break;
     }
     value += ((i - 1) * 40000L);
+    *counted_home = MIN(i, borg.trait[BI_MAXDEPTH] + 50) >= 82;
+
+    return value;
+}
+
+/*
+ * Calculate the "power" of the Borg
+ */
+int32_t borg_power(void)
+{
+    struct borg_power_memo *memo;
+    int32_t                 value;
+
+    memo = &borg_power_memos[borg_power_note() % BORG_POWER_MEMO];
+    if (borg_power_same(memo)) {
+        value              = memo->value;
+        borg.ready_morgoth = memo->ready_morgoth;
+    } else {
+        bool counted_home;
+
+        value = borg_power_aux(&counted_home);
+
+        borg_power_keep(memo);
+        memo->counted_home  = counted_home;
+        memo->value         = value;
+        memo->ready_morgoth = borg.ready_morgoth;
+    }
 
     /* Add the value for the swap items */
     value += weapon_swap_value;
@@ -1915,4 +2108,50 @@ int32_t borg_power(void)
     /* Return the value */
     return (value);
 }
+
+/*
+ * Make room for the powers judged lately
+ */
+void borg_init_power(void)
+{
+    const struct player_class *c;
+    int                        spells = 0;
+    int                        i;
+
+    /* Room for the spells of any class, as the borg may be reincarnated */
+    for (c = classes; c; c = c->next)
+        spells = MAX(spells, c->magic.total_spells);
+
+    borg_power_gear_size = INVEN_TOTAL * sizeof(struct borg_power_gear);
+    borg_power_gear_now  = mem_zalloc(borg_power_gear_size);
+    borg_power_memos
+        = mem_zalloc(BORG_POWER_MEMO * sizeof(struct borg_power_memo));
+    for (i = 0; i < BORG_POWER_MEMO; i++) {
+        borg_power_memos[i].gear   = mem_zalloc(borg_power_gear_size);
+        borg_power_memos[i].trait  = mem_zalloc(BI_MAX * sizeof(int));
+        borg_power_memos[i].cfg
+            = mem_zalloc(BORG_MAX_SETTINGS * sizeof(int));
+        borg_power_memos[i].spells = mem_zalloc(MAX(spells, 1));
+    }
+}
+
+/*
+ * Forget the powers judged lately
+ */
+void borg_free_power(void)
+{
+    int i;
+
+    for (i = 0; borg_power_memos && i < BORG_POWER_MEMO; i++) {
+        mem_free(borg_power_memos[i].gear);
+        mem_free(borg_power_memos[i].trait);
+        mem_free(borg_power_memos[i].cfg);
+        mem_free(borg_power_memos[i].spells);
+    }
+    mem_free(borg_power_memos);
+    borg_power_memos = NULL;
+    mem_free(borg_power_gear_now);
+    borg_power_gear_now = NULL;
+}
+
 #endif
@@ -28,5 +28,11 @@
  */
 extern int32_t borg_power(void);
 
+/*
+ * Initialize and free the memory of the power of gear judged lately
+ */
+extern void borg_init_power(void);
+extern void borg_free_power(void);
+
 #endif
 #endif
@@ -65,6 +65,10 @@ bool borg_los(int y1, int x1, int y2, int x2)
     /* Slope, or 1/Slope, of LOS */
     int m;
 
+    /* Precomputed ray */
+    const int8_t *ray_x, *ray_y;
+    int n, i;
+
     /* Extract the offset */
     dy = y2 - y1;
     dx = x2 - x1;
@@ -145,6 +149,16 @@ bool borg_los(int y1, int x1, int y2, int x2)
         }
     }
 
+    /* Walk the ray precomputed for los(), if there is one */
+    n = los_ray(loc(dx, dy), &ray_x, &ray_y);
+    if (n >= 0) {
+        for (i = 0; i < n; i++) {
+            if (!borg_cave_floor_bold(y1 + ray_y[i], x1 + ray_x[i]))
+                return false;
+        }
+        return true;
+    }
+
     /* Calculate scale factor div 2 */
     f2 = (ax * ay);
 
@@ -799,6 +813,7 @@ bool borg_target_unknown_wall(int y, int x)
                     n_y, n_x, n_y, n_x));
             borg_grids[n_y][n_x].feat = FEAT_GRANITE;
             found                     = true;
+            borg_danger_forget();
             return (found); /* not sure... should we return here? */
         }
 
@@ -809,6 +824,7 @@ bool borg_target_unknown_wall(int y, int x)
                 "# Guessing wall (%d,%d) near target (%d,%d)", n_y, n_x, y, x));
             borg_grids[n_y][n_x].feat = FEAT_GRANITE;
             found                     = true;
+            borg_danger_forget();
             return (found); /* not sure... should we return here?
                              maybe should mark ALL unknowns in path... */
         }
@@ -821,6 +837,7 @@ bool borg_target_unknown_wall(int y, int x)
                 "# Guessing wall (%d,%d) near target (%d,%d)", n_y, n_x, y, x));
             borg_grids[n_y][n_x].feat = FEAT_GRANITE;
             found                     = true;
+            borg_danger_forget();
             return (found);
         }
 
@@ -42,6 +42,7 @@
 #include "borg-item-wear.h"
 #include "borg-junk.h"
 #include "borg-messages.h"
+#include "borg-observe.h"
 #include "borg-prepared.h"
 #include "borg-projection.h"
 #include "borg-store-buy.h"
@@ -255,7 +256,7 @@ static void borg_update_map(void)
     int i, x, y, dx, dy;
 
     borg_grid       *ag;
-    struct grid_data g;
+    struct borg_seen g;
 
     /* Analyze the current map panel */
     for (dy = 0; dy < SCREEN_HGT; dy++) {
@@ -268,13 +269,13 @@ static void borg_update_map(void)
             x = w_x + dx;
             y = w_y + dy;
 
-            /* Cheat the exact information from the screen */
+            /* Cheat the exact information from the character's knowledge */
             struct loc l = loc(x, y);
             /* since the map is now dynamically sized, double check we are in
              * bounds */
             if (!square_in_bounds(cave, l))
                 continue;
-            map_info(l, &g);
+            borg_observe_grid(l, &g);
 
             /* Get the borg_grid */
             ag = &borg_grids[y][x];
@@ -286,13 +287,13 @@ static void borg_update_map(void)
             /* if this square is not in view and the borg previously */
             /* cast stone to mud here, ignore the map info so repeated */
             /* stone to mud aren't cast */
-            if (g.f_idx != FEAT_NONE
+            if (g.feat != FEAT_NONE
                 && (g.in_view || !(ag->info & BORG_IGNORE_MAP))) {
                 if (g.in_view) {
                     ag->info &= ~BORG_IGNORE_MAP;
                 }
                 ag->info |= BORG_MARK;
-                ag->feat = g.f_idx;
+                ag->feat = g.feat;
             }
 
             /* default store to - 1 */
@@ -310,9 +311,9 @@ static void borg_update_map(void)
 
             /* Analyze know information about grid */
             /* Shop Doors */
-            if (feat_is_shop(g.f_idx)) {
+            if (feat_is_shop(g.feat)) {
                 /* Shop type */
-                ag->feat  = g.f_idx;
+                ag->feat  = g.feat;
 
                 i         = square_shopnum(cave, l);
                 ag->store = i;
@@ -346,7 +347,7 @@ static void borg_update_map(void)
                 }
             }
             /* Darkness */
-            else if (g.f_idx == FEAT_NONE) {
+            else if (g.feat == FEAT_NONE) {
                 /* The grid is not lit */
                 ag->info &= ~BORG_GLOW;
 
@@ -355,7 +356,7 @@ static void borg_update_map(void)
                     ag->info |= BORG_DARK;
             }
             /* Floors */
-            else if (g.f_idx == FEAT_NONE) {
+            else if (g.feat == FEAT_NONE) {
                 /* Handle "blind" */
                 if (borg.trait[BI_ISBLIND]) {
                     /* Nothing */
@@ -386,10 +387,10 @@ static void borg_update_map(void)
                 }
             }
             /* Open doors */
-            else if (g.f_idx == FEAT_OPEN || g.f_idx == FEAT_BROKEN) {
+            else if (g.feat == FEAT_OPEN || g.feat == FEAT_BROKEN) {
             }
             /* Walls */
-            else if (g.f_idx == FEAT_GRANITE || g.f_idx == FEAT_PERM) {
+            else if (g.feat == FEAT_GRANITE || g.feat == FEAT_PERM) {
                 /* ok this is a humongo cheat.  He is pulling the
                  * grid information from the game rather than from
                  * his memory.  He is going to see if the wall is perm.
@@ -421,16 +422,16 @@ static void borg_update_map(void)
                 }
             }
             /* lava */
-            else if (g.f_idx == FEAT_LAVA) {
+            else if (g.feat == FEAT_LAVA) {
             }
             /* Seams and rubble */
-            else if (g.f_idx == FEAT_MAGMA || g.f_idx == FEAT_QUARTZ
-                     || g.f_idx == FEAT_RUBBLE) {
+            else if (g.feat == FEAT_MAGMA || g.feat == FEAT_QUARTZ
+                     || g.feat == FEAT_RUBBLE) {
                 /* If we are twitching around unable to go anywhere, count */
                 /* regular veins as worth digging out */
                 if (borg.times_twitch > 21) {
                     /* but only quartz if we can dig it */
-                    if (!borg_can_dig(true, FEAT_QUARTZ_K) && g.f_idx == FEAT_QUARTZ)
+                    if (!borg_can_dig(true, FEAT_QUARTZ_K) && g.feat == FEAT_QUARTZ)
                         continue;
 
                     /* Check for an existing vein */
@@ -453,7 +454,7 @@ static void borg_update_map(void)
                 }
             }
             /* Hidden */
-            else if (g.f_idx == FEAT_MAGMA_K || g.f_idx == FEAT_QUARTZ_K) {
+            else if (g.feat == FEAT_MAGMA_K || g.feat == FEAT_QUARTZ_K) {
                 /* Check for an existing vein */
                 for (i = 0; i < track_vein.num; i++) {
                     /* Stop if we already new about this */
@@ -473,7 +474,7 @@ static void borg_update_map(void)
                 }
             }
             /* Doors */
-            else if (g.f_idx == FEAT_CLOSED) {
+            else if (g.feat == FEAT_CLOSED) {
                 /* Only while low level */
                 if (borg.trait[BI_CLEVEL] <= 5) {
                     /* Check for an existing door */
@@ -497,7 +498,7 @@ static void borg_update_map(void)
                 }
             }
             /* Up stairs */
-            else if (g.f_idx == FEAT_LESS) {
+            else if (g.feat == FEAT_LESS) {
                 /* Check for an existing "up stairs" */
                 for (i = 0; i < track_less.num; i++) {
                     /* Stop if we already new about these stairs */
@@ -513,7 +514,7 @@ static void borg_update_map(void)
                 }
             }
             /* Down stairs */
-            else if (g.f_idx == FEAT_MORE) {
+            else if (g.feat == FEAT_MORE) {
                 /* Check for an existing "down stairs" */
                 for (i = 0; i < track_more.num; i++) {
                     /* We already knew about that one */
@@ -535,7 +536,7 @@ static void borg_update_map(void)
                 ag->web = false;          
 
             /* Now do non-feature stuff */
-            if ((g.first_kind || g.m_idx) && !borg.trait[BI_ISIMAGE]) {
+            if ((g.first_kind || g.mon) && !borg.trait[BI_ISIMAGE]) {
                 /* Monsters/Objects */
                 borg_wank *wank;
 
@@ -543,7 +544,7 @@ static void borg_update_map(void)
                 if (borg_wank_num == AUTO_VIEW_MAX) {
                     borg_note(format("# Wank problem at grid (%d,%d) m:%lu "
                                      "o:%lu, borg at (%d,%d)",
-                        y, x, (unsigned long)g.m_idx,
+                        y, x, (unsigned long)(g.mon ? g.mon->midx : 0),
                         (unsigned long)(g.first_kind ? g.first_kind->kidx : 0),
                         borg.c.y, borg.c.x));
                     borg_oops("too many objects...");
@@ -558,16 +559,15 @@ static void borg_update_map(void)
                 /* monster symbol takes priority */
                 /* TODO: Store known information about monster/object, instead
                  * of just the screen character */
-                if (g.m_idx) {
-                    struct monster *m_ptr = cave_monster(cave, g.m_idx);
-                    wank->t_a             = m_ptr->attr;
-                    wank->t_c             = r_info[m_ptr->race->ridx].d_char;
+                if (g.mon) {
+                    wank->t_a = g.mon->attr;
+                    wank->t_c = g.mon->race->d_char;
                 } else {
                     wank->t_a = g.first_kind->d_attr;
                     wank->t_c = g.first_kind->d_char;
                 }
                 wank->is_take = (g.first_kind != NULL);
-                wank->is_kill = (g.m_idx != 0);
+                wank->is_kill = (g.mon != NULL);
             }
 
             /* Save the new "wall" or "door" */
@@ -1536,6 +1536,9 @@ void borg_update(void)
     bool monster_in_vault = false;
     bool created_traps    = false;
 
+    /* What the borg knows is about to change */
+    borg_danger_begin_update();
+
     /*** Process objects/monsters ***/
 
     /* Scan monsters */
@@ -3049,6 +3052,9 @@ void borg_update(void)
 
     /* Default "goal" location */
     borg.goal.g = borg.c;
+
+    /* Work out the danger again if anything has been learned */
+    borg_danger_end_update();
 }
 
 void borg_init_update(void)
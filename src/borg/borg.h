@@ -56,6 +56,7 @@ enum {
     BORG_KILLS_UNIQUES,
     BORG_USES_SWAPS,
     BORG_USES_DYNAMIC_CALCS,
+    BORG_COMPILES_FORMULAS,
     BORG_STOP_DLEVEL,
     BORG_STOP_CLEVEL,
     BORG_NO_DEEPER,
@@ -978,6 +978,23 @@ int square_light(struct chunk *c, struct loc grid)
 	return square(c, grid)->light;
 }
 
+/**
+ * Get the age of the player's scent in a grid, or 0 if there is none.
+ *
+ * Scent that has aged beyond what a 16-bit count could hold is treated as
+ * gone, as it was when the ages were stored directly.
+ */
+int square_scent(struct chunk *c, struct loc grid)
+{
+	uint32_t stamp, age;
+
+	assert(square_in_bounds(c, grid));
+	stamp = c->scent.grids[grid.y][grid.x];
+	if (!stamp) return 0;
+	age = c->scent.count - stamp;
+	return (age > UINT16_MAX) ? 0 : (int) age;
+}
+
 /**
  * Get a monster on the current level by its position.
  */
@@ -20,6 +20,7 @@
 #include "cave.h"
 #include "cmds.h"
 #include "init.h"
+#include "game-profile.h"
 #include "game-world.h"
 #include "monster.h"
 #include "player-calcs.h"
@@ -46,6 +47,216 @@ int distance(struct loc grid1, struct loc grid2)
 }
 
 
+/**
+ * Precomputed line-of-sight rays.
+ *
+ * For every offset within los_ray_radius of the origin, the grids which
+ * los() has to check, relative to the origin, are stored in order.  The
+ * coordinates are kept as separate arrays of bytes to keep the table small;
+ * the rays for the offset with index i run from los_ray_start[i] up to
+ * los_ray_start[i + 1].
+ */
+static int los_ray_radius;
+static uint32_t *los_ray_start;
+static int8_t *los_ray_x;
+static int8_t *los_ray_y;
+
+/**
+ * Index of an offset in the line-of-sight ray table
+ */
+static int los_ray_index(int dx, int dy)
+{
+	return (dy + los_ray_radius) * (2 * los_ray_radius + 1)
+		+ dx + los_ray_radius;
+}
+
+/**
+ * Record the grids, relative to the origin, which los() checks for the given
+ * offset.  This follows the stepping of los() exactly, except for the
+ * "knight's move" shortcut which depends on the terrain.
+ * \param dx Is the horizontal offset of the target.
+ * \param dy Is the vertical offset of the target.
+ * \param path Is where the grids are stored; may be NULL to just count them.
+ * \return the number of grids in the ray.
+ */
+static int los_ray_trace(int dx, int dy, struct loc *path)
+{
+	int ax = ABS(dx), ay = ABS(dy);
+	int sx = (dx < 0) ? -1 : 1, sy = (dy < 0) ? -1 : 1;
+	int qx, qy, tx, ty, f1, f2, m;
+	int n = 0;
+
+	/* Adjacent (or identical) grids need no checks */
+	if ((ax < 2) && (ay < 2)) return 0;
+
+	/* Directly South/North */
+	if (!dx) {
+		for (ty = sy; ty != dy; ty += sy) {
+			if (path) path[n] = loc(0, ty);
+			n++;
+		}
+		return n;
+	}
+
+	/* Directly East/West */
+	if (!dy) {
+		for (tx = sx; tx != dx; tx += sx) {
+			if (path) path[n] = loc(tx, 0);
+			n++;
+		}
+		return n;
+	}
+
+	f2 = (ax * ay);
+	f1 = f2 << 1;
+
+	if (ax >= ay) {
+		/* Travel horizontally */
+		qy = ay * ay;
+		m = qy << 1;
+		tx = sx;
+		if (qy == f2) {
+			ty = sy;
+			qy -= f1;
+		} else {
+			ty = 0;
+		}
+		while (dx - tx) {
+			if (path) path[n] = loc(tx, ty);
+			n++;
+			qy += m;
+			if (qy < f2) {
+				tx += sx;
+			} else if (qy > f2) {
+				ty += sy;
+				if (path) path[n] = loc(tx, ty);
+				n++;
+				qy -= f1;
+				tx += sx;
+			} else {
+				ty += sy;
+				qy -= f1;
+				tx += sx;
+			}
+		}
+	} else {
+		/* Travel vertically */
+		qx = ax * ax;
+		m = qx << 1;
+		ty = sy;
+		if (qx == f2) {
+			tx = sx;
+			qx -= f1;
+		} else {
+			tx = 0;
+		}
+		while (dy - ty) {
+			if (path) path[n] = loc(tx, ty);
+			n++;
+			qx += m;
+			if (qx < f2) {
+				ty += sy;
+			} else if (qx > f2) {
+				tx += sx;
+				if (path) path[n] = loc(tx, ty);
+				n++;
+				qx -= f1;
+				ty += sy;
+			} else {
+				tx += sx;
+				qx -= f1;
+				ty += sy;
+			}
+		}
+	}
+
+	return n;
+}
+
+/**
+ * Build the line-of-sight ray table, covering offsets up to the larger of the
+ * maximum sight and maximum projection ranges.
+ */
+static void init_los_rays(void)
+{
+	/* The offsets have to fit in a signed byte; los() walks further ones */
+	int radius = MIN(MAX(z_info->max_sight, z_info->max_range), INT8_MAX);
+	int count = (2 * radius + 1) * (2 * radius + 1);
+	struct loc *path = mem_alloc(4 * (radius + 1) * sizeof(*path));
+	uint32_t total = 0;
+	int dx, dy, i;
+
+	los_ray_radius = radius;
+	los_ray_start = mem_zalloc((count + 1) * sizeof(*los_ray_start));
+
+	/* Count the grids for each offset */
+	for (dy = -radius; dy <= radius; dy++) {
+		for (dx = -radius; dx <= radius; dx++) {
+			los_ray_start[los_ray_index(dx, dy)] = total;
+			total += los_ray_trace(dx, dy, NULL);
+		}
+	}
+	los_ray_start[count] = total;
+
+	/* Fill in the grids */
+	los_ray_x = mem_zalloc(MAX(total, 1) * sizeof(*los_ray_x));
+	los_ray_y = mem_zalloc(MAX(total, 1) * sizeof(*los_ray_y));
+	for (dy = -radius; dy <= radius; dy++) {
+		for (dx = -radius; dx <= radius; dx++) {
+			uint32_t start = los_ray_start[los_ray_index(dx, dy)];
+			int n = los_ray_trace(dx, dy, path);
+
+			for (i = 0; i < n; i++) {
+				los_ray_x[start + i] = (int8_t) path[i].x;
+				los_ray_y[start + i] = (int8_t) path[i].y;
+			}
+		}
+	}
+
+	mem_free(path);
+}
+
+static void cleanup_los_rays(void)
+{
+	mem_free(los_ray_start);
+	los_ray_start = NULL;
+	mem_free(los_ray_x);
+	los_ray_x = NULL;
+	mem_free(los_ray_y);
+	los_ray_y = NULL;
+	los_ray_radius = 0;
+}
+
+struct init_module los_module = {
+	.name = "los",
+	.init = init_los_rays,
+	.cleanup = cleanup_los_rays
+};
+
+/**
+ * Get the precomputed line-of-sight ray for an offset.
+ * \param offset Is the position of the target relative to the origin.
+ * \param ray_x Is set to the horizontal components of the ray's grids.
+ * \param ray_y Is set to the vertical components of the ray's grids.
+ * \return the number of grids in the ray, or -1 if the offset is not covered
+ * by the table.  The grids are the ones los() requires to be projectable,
+ * excluding the "knight's move" special case; they are relative to the origin.
+ */
+int los_ray(struct loc offset, const int8_t **ray_x, const int8_t **ray_y)
+{
+	int i;
+
+	if (!los_ray_start || ABS(offset.x) > los_ray_radius
+			|| ABS(offset.y) > los_ray_radius) {
+		return -1;
+	}
+	i = los_ray_index(offset.x, offset.y);
+	*ray_x = los_ray_x + los_ray_start[i];
+	*ray_y = los_ray_y + los_ray_start[i];
+	return (int) (los_ray_start[i + 1] - los_ray_start[i]);
+}
+
+
 /**
  * A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
  * 4116 Brewster Drive, Raleigh NC 27606.  Email to jnh@ecemwl.ncsu.edu.
@@ -81,6 +292,10 @@ int distance(struct loc grid1, struct loc grid2)
  * are "viewable" by the player, which is used for many things, such as
  * determining which grids are illuminated by the player's torch, and which
  * grids and monsters can be "seen" by the player, etc).
+ *
+ * Offsets within the maximum sight or projection range use the rays
+ * precomputed by init_los_rays(), so only the walls along the way need to
+ * be looked up.
  */
 bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 {
@@ -105,6 +320,10 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 	/* Slope, or 1/Slope, of LOS */
 	int m;
 
+	/* Precomputed ray */
+	const int8_t *ray_x, *ray_y;
+	int n, i;
+
 	/* Extract the offset */
 	dy = grid2.y - grid1.y;
 	dx = grid2.x - grid1.x;
@@ -116,6 +335,30 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 	/* Handle adjacent (or identical) grids */
 	if ((ax < 2) && (ay < 2)) return (true);
 
+	/* Extract some signs */
+	sx = (dx < 0) ? -1 : 1;
+	sy = (dy < 0) ? -1 : 1;
+
+	/* Vertical and horizontal "knights" */
+	if ((ax == 1) && (ay == 2) &&
+		square_isprojectable(c, loc(grid1.x, grid1.y + sy))) {
+		return (true);
+	} else if ((ay == 1) && (ax == 2) &&
+			   square_isprojectable(c, loc(grid1.x + sx, grid1.y))) {
+		return (true);
+	}
+
+	/* Walk the precomputed ray, if there is one */
+	n = los_ray(loc(dx, dy), &ray_x, &ray_y);
+	if (n >= 0) {
+		for (i = 0; i < n; i++) {
+			struct loc grid = loc(grid1.x + ray_x[i], grid1.y + ray_y[i]);
+
+			if (!square_isprojectable(c, grid)) return (false);
+		}
+		return (true);
+	}
+
 	/* Directly South/North */
 	if (!dx) {
 		/* South -- check for walls */
@@ -146,20 +389,6 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 		return (true);
 	}
 
-
-	/* Extract some signs */
-	sx = (dx < 0) ? -1 : 1;
-	sy = (dy < 0) ? -1 : 1;
-
-	/* Vertical and horizontal "knights" */
-	if ((ax == 1) && (ay == 2) &&
-		square_isprojectable(c, loc(grid1.x, grid1.y + sy))) {
-		return (true);
-	} else if ((ay == 1) && (ax == 2) &&
-			   square_isprojectable(c, loc(grid1.x + sx, grid1.y))) {
-		return (true);
-	}
-
 	/* Calculate scale factor div 2 */
 	f2 = (ax * ay);
 
@@ -431,13 +660,16 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 
 /**
  * Mark the currently seen grids, then wipe in preparation for recalculating
+ *
+ * Only the grids within the bounds recorded by the last update can be in view,
+ * so those are all that need checking.
  */
 static void mark_wasseen(struct chunk *c)
 {
 	int x, y;
 	/* Save the old "view" grids for later */
-	for (y = 0; y < c->height; y++) {
-		for (x = 0; x < c->width; x++) {
+	for (y = c->view_top_left.y; y <= c->view_bottom_right.y; y++) {
+		for (x = c->view_top_left.x; x <= c->view_bottom_right.x; x++) {
 			struct loc grid = loc(x, y);
 			if (square_isseen(c, grid))
 				sqinfo_on(square(c, grid)->info, SQUARE_WASSEEN);
@@ -871,6 +1103,11 @@ static void update_one(struct chunk *c, struct loc grid, struct player *p)
 void update_view(struct chunk *c, struct player *p)
 {
 	int x, y;
+	struct loc old_top_left = c->view_top_left;
+	struct loc old_bottom_right = c->view_bottom_right;
+	struct loc top_left, bottom_right;
+
+	profile_enter(PROFILE_VIEW);
 
 	/* Record the current view */
 	mark_wasseen(c);
@@ -896,15 +1133,37 @@ void update_view(struct chunk *c, struct player *p)
 		square_forget(c, p->grid);
 	}
 
+	/* Only grids within sight range of the player can come into view */
+	top_left = loc(MAX(p->grid.x - z_info->max_sight, 0),
+		MAX(p->grid.y - z_info->max_sight, 0));
+	bottom_right = loc(MIN(p->grid.x + z_info->max_sight, c->width - 1),
+		MIN(p->grid.y + z_info->max_sight, c->height - 1));
+
 	/* Squares we have LOS to get marked as in the view, and perhaps seen */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
+	for (y = top_left.y; y <= bottom_right.y; y++)
+		for (x = top_left.x; x <= bottom_right.x; x++)
 			update_view_one(c, loc(x, y), p);
 
-	/* Update each grid */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
+	/* Update each grid which is in view now */
+	for (y = top_left.y; y <= bottom_right.y; y++)
+		for (x = top_left.x; x <= bottom_right.x; x++)
+			update_one(c, loc(x, y), p);
+
+	/* Update the rest of the grids which may have been in view before */
+	for (y = old_top_left.y; y <= old_bottom_right.y; y++) {
+		for (x = old_top_left.x; x <= old_bottom_right.x; x++) {
+			if (y >= top_left.y && y <= bottom_right.y
+					&& x >= top_left.x && x <= bottom_right.x)
+				continue;
 			update_one(c, loc(x, y), p);
+		}
+	}
+
+	/* Remember where the view flags are for the next update */
+	c->view_top_left = top_left;
+	c->view_bottom_right = bottom_right;
+
+	profile_leave(PROFILE_VIEW);
 }
 
 
@@ -24,6 +24,7 @@
 #include "game-world.h"
 #include "init.h"
 #include "mon-group.h"
+#include "mon-move.h"
 #include "monster.h"
 #include "obj-ignore.h"
 #include "obj-pile.h"
@@ -338,28 +339,72 @@ const char *get_feat_code_name(int idx)
 	return (idx < 0 || idx >= FEAT_MAX) ? NULL : feat_code_list[idx];
 }
 
+/**
+ * Allocate the squares, their info flags and the heatmaps of a chunk
+ */
+static void cave_alloc_grids(struct chunk *c)
+{
+	int y, i;
+	bitflag *info;
+
+	/*
+	 * Squares, their info flags and the heatmaps are each kept as a single
+	 * row-major block; the row pointers just index into it.
+	 */
+	c->squares = mem_zalloc(c->height * sizeof(struct square*));
+	c->squares[0] = mem_zalloc(c->height * c->width * sizeof(struct square));
+	info = mem_zalloc(c->height * c->width * SQUARE_SIZE * sizeof(bitflag));
+	c->noise.grids = mem_zalloc(c->height * sizeof(uint16_t*));
+	c->noise.grids[0] = mem_zalloc(c->height * c->width * sizeof(uint16_t));
+	c->scent.grids = mem_zalloc(c->height * sizeof(uint32_t*));
+	c->scent.grids[0] = mem_zalloc(c->height * c->width * sizeof(uint32_t));
+	for (y = 1; y < c->height; y++) {
+		c->squares[y] = c->squares[0] + y * c->width;
+		c->noise.grids[y] = c->noise.grids[0] + y * c->width;
+		c->scent.grids[y] = c->scent.grids[0] + y * c->width;
+	}
+	for (i = 0; i < c->height * c->width; i++) {
+		c->squares[0][i].info = info + i * SQUARE_SIZE;
+	}
+}
+
+/**
+ * Free what cave_alloc_grids() allocated
+ */
+static void cave_free_grids(struct chunk *c)
+{
+	mem_free(c->squares[0][0].info);
+	mem_free(c->squares[0]);
+	mem_free(c->squares);
+	c->squares = NULL;
+	mem_free(c->noise.grids[0]);
+	mem_free(c->noise.grids);
+	c->noise.grids = NULL;
+	mem_free(c->noise_list);
+	c->noise_list = NULL;
+	c->noise_count = 0;
+	mem_free(c->scent.grids[0]);
+	mem_free(c->scent.grids);
+	c->scent.grids = NULL;
+}
+
 /**
  * Allocate a new chunk of the world
  */
 struct chunk *cave_new(int height, int width) {
-	int y, x;
-
 	struct chunk *c = mem_zalloc(sizeof *c);
 	c->height = height;
 	c->width = width;
 	c->feat_count = mem_zalloc((FEAT_MAX + 1) * sizeof(int));
 
-	c->squares = mem_zalloc(c->height * sizeof(struct square*));
-	c->noise.grids = mem_zalloc(c->height * sizeof(uint16_t*));
-	c->scent.grids = mem_zalloc(c->height * sizeof(uint16_t*));
-	for (y = 0; y < c->height; y++) {
-		c->squares[y] = mem_zalloc(c->width * sizeof(struct square));
-		for (x = 0; x < c->width; x++) {
-			c->squares[y][x].info = mem_zalloc(SQUARE_SIZE * sizeof(bitflag));
-		}
-		c->noise.grids[y] = mem_zalloc(c->width * sizeof(uint16_t));
-		c->scent.grids[y] = mem_zalloc(c->width * sizeof(uint16_t));
-	}
+	cave_alloc_grids(c);
+
+	/* Start the scent count past the freshest scent so 0 is never a stamp */
+	c->scent.count = SCENT_MAX_FRESH + 1;
+
+	/* View flags could be anywhere until the first view update */
+	c->view_top_left = loc(0, 0);
+	c->view_bottom_right = loc(c->width - 1, c->height - 1);
 
 	c->objects = mem_zalloc(OBJECT_LIST_SIZE * sizeof(struct object*));
 	c->obj_max = OBJECT_LIST_SIZE - 1;
@@ -396,6 +441,9 @@ void cave_free(struct chunk *c) {
 	struct chunk *p_c = (c == cave && player) ? player->cave : NULL;
 	int y, x, i;
 
+	if (c->packed)
+		cave_unpack(c);
+
 	cave_connectors_free(c->join);
 
 	/* Look for orphaned objects and delete them. */
@@ -407,30 +455,260 @@ void cave_free(struct chunk *c) {
 
 	for (y = 0; y < c->height; y++) {
 		for (x = 0; x < c->width; x++) {
-			mem_free(c->squares[y][x].info);
 			if (c->squares[y][x].trap)
 				square_free_trap(c, loc(x, y));
 			if (c->squares[y][x].obj)
 				object_pile_free(c, p_c, c->squares[y][x].obj);
 		}
-		mem_free(c->squares[y]);
-		mem_free(c->noise.grids[y]);
-		mem_free(c->scent.grids[y]);
 	}
-	mem_free(c->squares);
-	mem_free(c->noise.grids);
-	mem_free(c->scent.grids);
+	cave_free_grids(c);
+	free_monster_schedule(c);
 
 	mem_free(c->feat_count);
 	mem_free(c->objects);
 	mem_free(c->monsters);
 	mem_free(c->monster_groups);
+	mem_free(c->saved);
 	if (c->name)
 		string_free(c->name);
 	mem_free(c);
 }
 
 
+/**
+ * A square of a packed chunk which has a monster, objects or traps
+ */
+struct packed_grid {
+	int index;
+	int16_t mon;
+	struct object *obj;
+	struct trap *trap;
+};
+
+/**
+ * The squares of a chunk while it is stored: the terrain, info flags,
+ * light and heatmaps as runs of equal values, and the few squares with
+ * anything on them listed separately
+ */
+struct packed_squares {
+	uint8_t *runs;
+	size_t runs_len;
+	size_t runs_size;
+	struct packed_grid *grids;
+	int grid_count;
+	bool from_saved;	/* Terrain and info are read back from c->saved */
+};
+
+/**
+ * Add bytes to the runs of a packed chunk
+ */
+static void pack_put(struct packed_squares *packed, const void *data,
+		size_t n)
+{
+	if (packed->runs_len + n > packed->runs_size) {
+		while (packed->runs_len + n > packed->runs_size)
+			packed->runs_size *= 2;
+		packed->runs = mem_realloc(packed->runs, packed->runs_size);
+	}
+	memcpy(packed->runs + packed->runs_len, data, n);
+	packed->runs_len += n;
+}
+
+/**
+ * Add n values of the given size as runs of at most 255 equal values, each
+ * a count byte followed by the value
+ */
+static void pack_runs(struct packed_squares *packed, const void *data,
+		size_t n, size_t size)
+{
+	const uint8_t *value = data;
+	size_t i = 0;
+
+	while (i < n) {
+		uint8_t run = 1;
+
+		while (i + run < n && run < 255 &&
+				!memcmp(value + i * size, value + (i + run) * size, size))
+			run++;
+		pack_put(packed, &run, 1);
+		pack_put(packed, value + i * size, size);
+		i += run;
+	}
+}
+
+/**
+ * Read back n values written by pack_runs() from the bytes before end.  The
+ * info and terrain runs wr_dungeon_aux() writes to a savefile have the same
+ * form, with one byte values.  Returns false if the runs end too soon or hold
+ * too many values.
+ */
+static bool unpack_runs(const uint8_t **pos, const uint8_t *end, void *data,
+		size_t n, size_t size)
+{
+	uint8_t *value = data;
+	size_t i = 0;
+
+	while (i < n) {
+		uint8_t run;
+
+		if (end - *pos < (ptrdiff_t) (1 + size)) return false;
+		run = *(*pos)++;
+		if (run > n - i) return false;
+		while (run--)
+			memcpy(value + (i++) * size, *pos, size);
+		*pos += size;
+	}
+	return true;
+}
+
+/**
+ * Pack away the squares of a chunk which is being stored.  Only the chunk's
+ * name, size, depth, connectors and the like, its objects and its monsters
+ * can be used until cave_unpack() is called.
+ *
+ * The monster list stays where it is, since things like the player's health
+ * tracking can still point into it.  If the level's savefile bytes are kept
+ * in c->saved, its terrain and info flags are read back from those rather
+ * than packed again.
+ */
+void cave_pack(struct chunk *c)
+{
+	struct packed_squares *packed;
+	int n = c->height * c->width;
+	uint8_t *feat;
+	int *light;
+	int i;
+
+	if (c->packed) return;
+
+	packed = mem_zalloc(sizeof(*packed));
+	packed->runs_size = 1024;
+	packed->runs = mem_alloc(packed->runs_size);
+
+	/* Terrain and light are gathered up from the squares first */
+	feat = mem_alloc(n * sizeof(*feat));
+	light = mem_alloc(n * sizeof(*light));
+	for (i = 0; i < n; i++) {
+		struct square *sq = &c->squares[0][i];
+
+		feat[i] = sq->feat;
+		light[i] = sq->light;
+		if (sq->mon || sq->obj || sq->trap)
+			packed->grid_count++;
+	}
+	/* Don't keep a second copy of what the savefile bytes hold */
+	packed->from_saved = c->saved != NULL;
+	if (!packed->from_saved) {
+		pack_runs(packed, feat, n, sizeof(*feat));
+		pack_runs(packed, c->squares[0][0].info, n, SQUARE_SIZE);
+	}
+	pack_runs(packed, light, n, sizeof(*light));
+	pack_runs(packed, c->noise.grids[0], n, sizeof(uint16_t));
+	pack_runs(packed, c->scent.grids[0], n, sizeof(uint32_t));
+	packed->runs = mem_realloc(packed->runs, packed->runs_len);
+	packed->runs_size = packed->runs_len;
+	mem_free(light);
+	mem_free(feat);
+
+	if (packed->grid_count) {
+		int j = 0;
+
+		packed->grids = mem_alloc(packed->grid_count *
+			sizeof(*packed->grids));
+		for (i = 0; i < n; i++) {
+			struct square *sq = &c->squares[0][i];
+
+			if (!sq->mon && !sq->obj && !sq->trap) continue;
+			packed->grids[j].index = i;
+			packed->grids[j].mon = sq->mon;
+			packed->grids[j].obj = sq->obj;
+			packed->grids[j].trap = sq->trap;
+			j++;
+		}
+	}
+
+	cave_free_grids(c);
+	c->packed = packed;
+}
+
+/**
+ * Restore the squares of a chunk packed by cave_pack()
+ */
+void cave_unpack(struct chunk *c)
+{
+	struct packed_squares *packed = c->packed;
+	int n = c->height * c->width;
+	const uint8_t *pos, *end;
+	uint8_t *feat;
+	int *light;
+	int i;
+	bool ok = true;
+
+	if (!packed) return;
+
+	cave_alloc_grids(c);
+	feat = mem_alloc(n * sizeof(*feat));
+	light = mem_alloc(n * sizeof(*light));
+	if (packed->from_saved) {
+		uint8_t *layer = mem_alloc(n);
+		size_t j;
+
+		/* The info flags are kept a layer at a time, then the terrain */
+		pos = c->saved + c->saved_squares;
+		end = c->saved + c->saved_len;
+		for (j = 0; ok && j < SQUARE_SIZE; j++) {
+			ok = unpack_runs(&pos, end, layer, n, 1);
+			for (i = 0; ok && i < n; i++)
+				c->squares[0][i].info[j] = layer[i];
+		}
+		ok = ok && unpack_runs(&pos, end, feat, n, sizeof(*feat));
+		mem_free(layer);
+	}
+	pos = packed->runs;
+	end = packed->runs + packed->runs_len;
+	if (!packed->from_saved) {
+		ok = ok && unpack_runs(&pos, end, feat, n, sizeof(*feat));
+		ok = ok && unpack_runs(&pos, end, c->squares[0][0].info, n,
+			SQUARE_SIZE);
+	}
+	ok = ok && unpack_runs(&pos, end, light, n, sizeof(*light));
+	ok = ok && unpack_runs(&pos, end, c->noise.grids[0], n,
+		sizeof(uint16_t));
+	ok = ok && unpack_runs(&pos, end, c->scent.grids[0], n,
+		sizeof(uint32_t));
+	if (!ok || pos != end)
+		quit_fmt("Stored level %s is corrupt", c->name);
+	for (i = 0; i < n; i++) {
+		c->squares[0][i].feat = feat[i];
+		c->squares[0][i].light = light[i];
+
+		/*
+		 * The list of grids with noise was dropped, but make_noise()
+		 * needs it to quieten them again
+		 */
+		if (c->noise.grids[0][i]) {
+			if (!c->noise_list)
+				c->noise_list = mem_alloc(n * sizeof(*c->noise_list));
+			c->noise_list[c->noise_count++] = i;
+		}
+	}
+	mem_free(light);
+	mem_free(feat);
+
+	for (i = 0; i < packed->grid_count; i++) {
+		struct square *sq = &c->squares[0][packed->grids[i].index];
+
+		sq->mon = packed->grids[i].mon;
+		sq->obj = packed->grids[i].obj;
+		sq->trap = packed->grids[i].trap;
+	}
+
+	mem_free(packed->grids);
+	mem_free(packed->runs);
+	mem_free(packed);
+	c->packed = NULL;
+}
+
 /**
  * Enter an object in the list of objects for the current level/chunk.  This
  * function is robust against listing of duplicates or non-objects
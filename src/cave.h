@@ -171,6 +171,39 @@ struct heatmap {
 	uint16_t **grids;
 };
 
+/**
+ * The player's scent trail.  Rather than aging every grid each turn, grids
+ * hold the value of the update counter at which their scent would have been
+ * fresh, so the age is the difference from the current count; 0 is no scent.
+ */
+#define SCENT_MAX_FRESH 2	/* Age of the oldest scent laid down each turn */
+
+struct scent_map {
+	uint32_t **grids;
+	uint32_t count;
+};
+
+/**
+ * The game turns on which monsters on the current level will next be able to
+ * move, so that monsters need only be visited when they act; see mon-move.c.
+ * Arrays other than head[] are indexed by monster.
+ */
+#define MON_SCHEDULE_BUCKETS 128
+
+struct monster_schedule {
+	int32_t *credited;	/* First game turn whose energy is not yet given */
+	int32_t *wake;		/* Game turn on which the monster can next move */
+	int *bucket;		/* Bucket holding the monster, or -1 for none */
+	int *next;		/* Next monster in the same bucket, or 0 */
+	int *prev;		/* Previous monster in the same bucket, or 0 */
+	int head[MON_SCHEDULE_BUCKETS];	/* First monster in each bucket */
+	int *due;		/* Monsters due to move this turn */
+	int *handled;		/* Monsters marked as handled this turn */
+	int handled_count;	/* Length of handled, or -1 if it overflowed */
+	int32_t scan_turn;	/* Game turn of the latest monster scan */
+	int scan_index;		/* Monster that scan has reached, 0 when done */
+};
+
 struct connector {
 	struct loc grid;
 	uint8_t feat;
@@ -195,8 +228,12 @@ struct chunk {
 	int *feat_count;
 
 	struct square **squares;
+	struct loc view_top_left;	/* Bounds of grids that may be in view */
+	struct loc view_bottom_right;
 	struct heatmap noise;
-	struct heatmap scent;
+	int *noise_list;	/* Grids given noise, in the order they were reached */
+	int noise_count;
+	struct scent_map scent;
 	struct loc decoy;
 
 	struct object **objects;
@@ -207,10 +244,19 @@ struct chunk {
 	uint16_t mon_cnt;
 	int mon_current;
 	int num_repro;
+	struct monster_schedule *schedule;
 
 	struct monster_group **monster_groups;
 
 	struct connector *join;
+
+	/* The bytes wr_chunks() last wrote for this chunk while it was stored */
+	uint8_t *saved;
+	uint32_t saved_len;
+	uint32_t saved_squares;	/* Where its info and terrain runs start */
+
+	/* The squares of a stored chunk, while they are packed away */
+	struct packed_squares *packed;
 };
 
 /*** Feature Indexes (see "lib/gamedata/terrain.txt") ***/
@@ -229,6 +275,7 @@ extern uint16_t chunk_list_max;
 
 /* cave-view.c */
 int distance(struct loc grid1, struct loc grid2);
+int los_ray(struct loc offset, const int8_t **ray_x, const int8_t **ray_y);
 bool los(struct chunk *c, struct loc grid1, struct loc grid2);
 void update_view(struct chunk *c, struct player *p);
 bool no_light(const struct player *p);
@@ -366,6 +413,7 @@ bool square_allows_summon(struct chunk *c, struct loc grid);
 const struct square *square(struct chunk *c, struct loc grid);
 struct feature *square_feat(struct chunk *c, struct loc grid);
 int square_light(struct chunk *c, struct loc grid);
+int square_scent(struct chunk *c, struct loc grid);
 struct monster *square_monster(struct chunk *c, struct loc grid);
 struct object *square_object(struct chunk *c, struct loc grid);
 struct trap *square_trap(struct chunk *c, struct loc grid);
@@ -433,6 +481,8 @@ const char *get_feat_code_name(int idx);
 struct chunk *cave_new(int height, int width);
 void cave_connectors_free(struct connector *join);
 void cave_free(struct chunk *c);
+void cave_pack(struct chunk *c);
+void cave_unpack(struct chunk *c);
 void list_object(struct chunk *c, struct object *obj);
 void delist_object(struct chunk *c, struct object *obj);
 void object_lists_check_integrity(struct chunk *c, struct chunk *c_k);
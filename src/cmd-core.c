@@ -22,6 +22,7 @@
 #include "cmd-core.h"
 #include "effects-info.h"
 #include "game-input.h"
+#include "game-record.h"
 #include "game-world.h"
 #include "obj-chest.h"
 #include "obj-desc.h"
@@ -145,6 +146,7 @@ static const struct command_info game_cmds[] =
 	{ CMD_WIZ_DETECT_ALL_MONSTERS, "detect all monsters", do_cmd_wiz_detect_all_monsters, false, false, 0 },
 	{ CMD_WIZ_DISPLAY_KEYLOG, "display keystroke log", do_cmd_wiz_display_keylog, false, false, 0 },
 	{ CMD_WIZ_DUMP_LEVEL_MAP, "write map of level", do_cmd_wiz_dump_level_map, false, false, 0 },
+	{ CMD_WIZ_DUMP_PROFILE, "write time spent in each phase of a turn", do_cmd_wiz_dump_profile, false, false, 0 },
 	{ CMD_WIZ_EDIT_PLAYER_EXP, "change the player's experience", do_cmd_wiz_edit_player_exp, false, false, 0 },
 	{ CMD_WIZ_EDIT_PLAYER_GOLD, "change the player's gold", do_cmd_wiz_edit_player_gold, false, false, 0 },
 	{ CMD_WIZ_EDIT_PLAYER_START, "start editing the player", do_cmd_wiz_edit_player_start, false, false, 0 },
@@ -409,6 +411,9 @@ bool cmdq_pop(cmd_context c)
 		cmd = &cmd_queue[cmd_tail++];
 		if (cmd_tail == CMD_QUEUE_SIZE)
 			cmd_tail = 0;
+
+		/* Write it to the record of the game, if there is one */
+		record_command(cmd, c);
 	} else {
 		/* Failure to get a command. */
 		return false;
@@ -133,6 +133,7 @@ typedef enum cmd_code {
 	CMD_WIZ_DETECT_ALL_MONSTERS,
 	CMD_WIZ_DISPLAY_KEYLOG,
 	CMD_WIZ_DUMP_LEVEL_MAP,
+	CMD_WIZ_DUMP_PROFILE,
 	CMD_WIZ_EDIT_PLAYER_EXP,
 	CMD_WIZ_EDIT_PLAYER_GOLD,
 	CMD_WIZ_EDIT_PLAYER_START,
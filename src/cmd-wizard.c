@@ -21,6 +21,7 @@
 #include "cmds.h"
 #include "effects.h"
 #include "game-input.h"
+#include "game-profile.h"
 #include "generate.h"
 #include "init.h"
 #include "mon-lore.h"
@@ -1166,6 +1167,29 @@ void do_cmd_wiz_dump_level_map(struct command *cmd)
 }
 
 
+/**
+ * Write the time spent in each phase of a game turn since the counts were
+ * last written, then start counting again (CMD_WIZ_DUMP_PROFILE).  Takes no
+ * arguments from cmd.
+ */
+void do_cmd_wiz_dump_profile(struct command *cmd)
+{
+	char path[1024] = "";
+
+	if (!profile_is_enabled()) {
+		msg("Profiling not turned on in this build.");
+		return;
+	}
+	if (!get_file("profile.txt", path, sizeof(path))) return;
+	if (profile_dump(path)) {
+		msg("Profile written to %s.", path);
+		profile_reset();
+	} else {
+		msg("Could not write the profile to %s.", path);
+	}
+}
+
+
 /**
  * Edit the player's amount of experience (CMD_WIZ_EDIT_PLAYER_EXP).  Takes
  * no arguments from cmd.
@@ -1496,7 +1520,7 @@ static void wiz_hack_map_peek_noise(struct chunk *c, void *closure,
 static void wiz_hack_map_peek_scent(struct chunk *c, void *closure,
 	struct loc grid, bool *show, uint8_t *color)
 {
-	if (c->scent.grids[grid.y][grid.x] == *((int*)closure)) {
+	if (square_scent(c, grid) == *((int*)closure)) {
 		*show = true;
 		*color = COLOUR_YELLOW;
 	} else {
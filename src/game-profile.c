@@ -0,0 +1,175 @@
+/**
+ * \file game-profile.c
+ * \brief Time spent in the phases of a game turn
+ *
+ * Copyright (c) 2026 Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ *
+ * Built with USE_PROFILING, the game keeps a count of the calls to each of
+ * the phases in enum profile_phase and the total time spent in them.  Without
+ * it, profile_enter() and profile_leave() compile to nothing.
+ */
+
+#include "angband.h"
+#include "game-profile.h"
+#include "game-world.h"
+#include "init.h"
+
+#ifdef USE_PROFILING
+
+static const char *profile_names[] = {
+	"player",
+	"monsters",
+	"world",
+	"notice",
+	"update",
+	"redraw",
+	"view",
+	"noise",
+	"generate",
+	"save"
+};
+
+static struct {
+	uint64_t calls;
+	uint64_t ns;
+	uint64_t start;
+	int depth;
+} profile[PROFILE_MAX];
+
+/* The game turn when counting began */
+static int32_t profile_turn;
+
+static char profile_exit_path[1024];
+
+/**
+ * A time in nanoseconds, from a clock which doesn't go backwards if the
+ * system has it
+ */
+static uint64_t profile_now(void)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#else
+	return (uint64_t) clock() * (1000000000 / CLOCKS_PER_SEC);
+#endif
+}
+
+/**
+ * Start timing a phase.  A phase entered again before it is left, as by
+ * recursion, is only timed from the outermost entry.
+ */
+void profile_enter(enum profile_phase phase)
+{
+	if (profile[phase].depth++ == 0)
+		profile[phase].start = profile_now();
+}
+
+/**
+ * Stop timing a phase
+ */
+void profile_leave(enum profile_phase phase)
+{
+	assert(profile[phase].depth > 0);
+	if (--profile[phase].depth == 0) {
+		profile[phase].ns += profile_now() - profile[phase].start;
+		profile[phase].calls++;
+	}
+}
+
+bool profile_is_enabled(void)
+{
+	return true;
+}
+
+/**
+ * Forget the counts so far; phases in progress are still timed when left
+ */
+void profile_reset(void)
+{
+	int i;
+
+	for (i = 0; i < PROFILE_MAX; i++) {
+		profile[i].calls = 0;
+		profile[i].ns = 0;
+	}
+	profile_turn = turn;
+}
+
+/**
+ * Write the counts to a file, one phase to a line: its name, the number of
+ * calls, the total and mean time in nanoseconds
+ */
+bool profile_dump(const char *path)
+{
+	ang_file *f = file_open(path, MODE_WRITE, FTYPE_TEXT);
+	int i;
+
+	if (!f) return false;
+
+	file_putf(f, "# turns %ld\n", (long) (turn - profile_turn));
+	file_putf(f, "# phase calls ns mean_ns\n");
+	for (i = 0; i < PROFILE_MAX; i++) {
+		unsigned long long mean = profile[i].calls ?
+			profile[i].ns / profile[i].calls : 0;
+		char line[128];
+
+		/* The game's own formatting doesn't do 64 bit numbers */
+		snprintf(line, sizeof(line), "%s %llu %llu %llu\n",
+			profile_names[i], (unsigned long long) profile[i].calls,
+			(unsigned long long) profile[i].ns, mean);
+		file_put(f, line);
+	}
+	return file_close(f);
+}
+
+static void profile_dump_exit(void)
+{
+	profile_dump(profile_exit_path);
+}
+
+/**
+ * Have the counts written to profile.txt in the user directory when the
+ * game exits, for the frontends which run without anyone to ask for them
+ */
+void profile_dump_at_exit(void)
+{
+	path_build(profile_exit_path, sizeof(profile_exit_path),
+		ANGBAND_DIR_USER, "profile.txt");
+	atexit(profile_dump_exit);
+}
+
+#else /* USE_PROFILING */
+
+bool profile_is_enabled(void)
+{
+	return false;
+}
+
+void profile_reset(void)
+{
+}
+
+bool profile_dump(const char *path)
+{
+	return false;
+}
+
+void profile_dump_at_exit(void)
+{
+}
+
+#endif /* USE_PROFILING */
@@ -0,0 +1,54 @@
+/**
+ * \file game-profile.h
+ * \brief Time spent in the phases of a game turn
+ *
+ * Copyright (c) 2026 Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef GAME_PROFILE_H
+#define GAME_PROFILE_H
+
+/**
+ * The phases which are timed.  They can nest, in which case the time of the
+ * inner phase also counts towards the outer one.
+ */
+enum profile_phase {
+	PROFILE_PLAYER,
+	PROFILE_MONSTERS,
+	PROFILE_WORLD,
+	PROFILE_NOTICE,
+	PROFILE_UPDATE,
+	PROFILE_REDRAW,
+	PROFILE_VIEW,
+	PROFILE_NOISE,
+	PROFILE_GENERATE,
+	PROFILE_SAVE,
+
+	PROFILE_MAX
+};
+
+#ifdef USE_PROFILING
+void profile_enter(enum profile_phase phase);
+void profile_leave(enum profile_phase phase);
+#else
+#define profile_enter(phase)
+#define profile_leave(phase)
+#endif
+
+bool profile_is_enabled(void);
+void profile_reset(void);
+bool profile_dump(const char *path);
+void profile_dump_at_exit(void);
+
+#endif /* !GAME_PROFILE_H */
@@ -0,0 +1,1098 @@
+/**
+ * \file game-record.c
+ * \brief Record the commands of a game, and replay them without a display
+ *
+ * Copyright (c) 2026 Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ *
+ * A record is a text file.  After the seed for the random numbers, there is
+ * a line for each command the game takes from its queue, with the options
+ * changed since the last one before it, its arguments after it, and then the
+ * answers to anything the game asked the frontend while carrying it out:
+ *
+ *     seed 1a2b3c4d
+ *     opt auto_more yes
+ *     cmd 12 2 0 0 5310
+ *     arg direction direction 6
+ *     ans check 1
+ *     interrupt 5480
+ *     end 9e3779b9
+ *
+ * The numbers on a command line are its code, context, repeats, whether it
+ * is a background command and the game turn.  Commands the game repeats by
+ * itself are not written again, but the frontend stopping them is.
+ *
+ * Before each command the random numbers start again from the seed and the
+ * number of commands so far, so whatever the frontend does with them between
+ * commands -- choosing a random name, say -- can't put a replay out of step.
+ * The last line is a hash of the state the game was left in, which a replay
+ * has to end with too.
+ *
+ * Replays start from a new character, so only games which start with one
+ * can be recorded.
+ */
+
+#include "angband.h"
+#include "buildid.h"
+#include "cave.h"
+#include "game-event.h"
+#include "game-input.h"
+#include "game-record.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "monster.h"
+#include "obj-util.h"
+#include "object.h"
+#include "option.h"
+#include "player-calcs.h"
+#include "player-timed.h"
+#include "player-util.h"
+#include "store.h"
+
+/**
+ * The frontend's answers to what the game asks it
+ */
+struct input_hooks {
+	bool (*get_string)(const char *prompt, char *buf, size_t len);
+	int (*get_quantity)(const char *prompt, int max);
+	bool (*get_check)(const char *prompt);
+	bool (*get_com)(const char *prompt, char *command);
+	bool (*get_rep_dir)(int *dir, bool allow_none);
+	bool (*get_aim_dir)(int *dir);
+	int (*get_spell_from_book)(struct player *p, const char *verb,
+		struct object *book, const char *error,
+		bool (*spell_filter)(const struct player *p, int spell));
+	int (*get_spell)(struct player *p, const char *verb,
+		item_tester book_filter, cmd_code cmd, const char *book_error,
+		bool (*spell_filter)(const struct player *p, int spell),
+		const char *spell_error, struct object **rtn_book);
+	bool (*get_item)(struct object **choice, const char *pmt,
+		const char *str, cmd_code cmd, item_tester tester, int mode);
+	bool (*get_curse)(int *choice, struct object *obj, char *dice_string);
+	int (*get_effect_from_list)(const char *prompt, struct effect *effect,
+		int count, bool allow_random);
+	bool (*confirm_debug)(void);
+};
+
+static const char *arg_type_names[] = {
+	"none",
+	"string",
+	"choice",
+	"item",
+	"number",
+	"direction",
+	"target",
+	"point"
+};
+
+/* The record being written or replayed, if any */
+static ang_file *record_file;
+static bool replaying;
+
+/* The seed, and the number of commands so far */
+static uint32_t record_seed;
+static uint32_t record_count;
+
+/* The frontend's hooks, while ours are in their place */
+static struct input_hooks saved_hooks;
+
+/* The options as they were last written */
+static bool record_opts[OPT_MAX];
+static bool record_opts_written;
+
+/* The next line of a replay, and a copy of the last one taken to pick apart */
+static char replay_line[1024];
+static char replay_taken[1024];
+static bool replay_line_read;
+static bool replay_line_end;
+static int replay_line_num;
+
+static bool replay_out_of_step;
+static bool replay_store_visited;
+
+/**
+ * ------------------------------------------------------------------------
+ * Hashing the state of the game
+ * ------------------------------------------------------------------------ */
+
+static uint32_t hash_int(uint32_t hash, int32_t value)
+{
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		hash ^= (uint32_t) (value >> (8 * i)) & 0xff;
+		hash *= 16777619;
+	}
+	return hash;
+}
+
+static uint32_t hash_object(uint32_t hash, const struct object *obj)
+{
+	hash = hash_int(hash, obj->kind ? obj->kind->kidx + 1 : 0);
+	hash = hash_int(hash, obj->number);
+	hash = hash_int(hash, obj->to_h);
+	hash = hash_int(hash, obj->to_d);
+	hash = hash_int(hash, obj->to_a);
+	hash = hash_int(hash, obj->pval);
+	return hash_int(hash, obj->timeout);
+}
+
+/**
+ * A hash of what matters about the state of the game: the character and
+ * what they carry, the level and what's on it, and the stores.  Two games
+ * which played out the same way have the same hash.
+ */
+uint32_t game_state_hash(void)
+{
+	uint32_t hash = 2166136261U;
+	struct object *obj;
+	int i, y, x;
+
+	hash = hash_int(hash, turn);
+	hash = hash_int(hash, seed_randart);
+	hash = hash_int(hash, seed_flavor);
+
+	hash = hash_int(hash, player->is_dead);
+	hash = hash_int(hash, player->depth);
+	hash = hash_int(hash, player->grid.y);
+	hash = hash_int(hash, player->grid.x);
+	hash = hash_int(hash, player->lev);
+	hash = hash_int(hash, player->exp);
+	hash = hash_int(hash, player->au);
+	hash = hash_int(hash, player->mhp);
+	hash = hash_int(hash, player->chp);
+	hash = hash_int(hash, player->csp);
+	hash = hash_int(hash, player->energy);
+	for (i = 0; i < STAT_MAX; i++) {
+		hash = hash_int(hash, player->stat_cur[i]);
+	}
+	for (i = 0; i < TMD_MAX; i++) {
+		hash = hash_int(hash, player->timed[i]);
+	}
+	for (obj = player->gear; obj; obj = obj->next) {
+		hash = hash_object(hash, obj);
+	}
+
+	if (cave) {
+		hash = hash_int(hash, cave->height);
+		hash = hash_int(hash, cave->width);
+		for (y = 0; y < cave->height; y++) {
+			for (x = 0; x < cave->width; x++) {
+				hash = hash_int(hash, square(cave, loc(x, y))->feat);
+			}
+		}
+		for (i = 1; i < cave->obj_max; i++) {
+			obj = cave->objects[i];
+			if (!obj) continue;
+			hash = hash_int(hash, obj->grid.y);
+			hash = hash_int(hash, obj->grid.x);
+			hash = hash_object(hash, obj);
+		}
+		for (i = 1; i < cave_monster_max(cave); i++) {
+			const struct monster *mon = cave_monster(cave, i);
+
+			if (!mon->race) continue;
+			hash = hash_int(hash, mon->race->ridx);
+			hash = hash_int(hash, mon->grid.y);
+			hash = hash_int(hash, mon->grid.x);
+			hash = hash_int(hash, mon->hp);
+		}
+	}
+
+	for (i = 0; stores && i < z_info->store_max; i++) {
+		for (obj = stores[i].stock; obj; obj = obj->next) {
+			hash = hash_object(hash, obj);
+		}
+	}
+
+	return hash;
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Objects in the record
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Describe where an object is, in a way which finds the same object when the
+ * game is replayed
+ */
+static void record_object_place(char *buf, size_t len,
+		const struct object *obj)
+{
+	const struct object *o;
+	int i, n;
+
+	if (!obj) {
+		my_strcpy(buf, "none", len);
+		return;
+	}
+
+	for (o = player->gear, n = 0; o; o = o->next, n++) {
+		if (o == obj) {
+			strnfmt(buf, len, "gear %d", n);
+			return;
+		}
+	}
+
+	if (cave && obj->oidx && obj->oidx < cave->obj_max
+			&& cave->objects[obj->oidx] == obj) {
+		strnfmt(buf, len, "floor %d", obj->oidx);
+		return;
+	}
+
+	for (i = 0; stores && i < z_info->store_max; i++) {
+		for (o = stores[i].stock, n = 0; o; o = o->next, n++) {
+			if (o == obj) {
+				strnfmt(buf, len, "store %d %d", i, n);
+				return;
+			}
+		}
+	}
+
+	/* Not an object the game can find again */
+	my_strcpy(buf, "none", len);
+}
+
+/**
+ * Read the next number of the line being picked apart by strtok()
+ */
+static int replay_int(void)
+{
+	const char *s = strtok(NULL, " ");
+
+	return s ? atoi(s) : 0;
+}
+
+/**
+ * Find the object described by record_object_place(), from the rest of the
+ * line being picked apart
+ */
+static struct object *replay_object(void)
+{
+	const char *where = strtok(NULL, " ");
+	struct object *obj = NULL;
+	int n;
+
+	if (!where) return NULL;
+
+	if (streq(where, "gear")) {
+		n = replay_int();
+		for (obj = player->gear; obj && n > 0; obj = obj->next, n--) ;
+	} else if (streq(where, "floor")) {
+		n = replay_int();
+		if (cave && n > 0 && n < cave->obj_max) obj = cave->objects[n];
+	} else if (streq(where, "store")) {
+		int s = replay_int();
+
+		n = replay_int();
+		if (stores && s >= 0 && s < z_info->store_max) {
+			for (obj = stores[s].stock; obj && n > 0; obj = obj->next, n--) ;
+		}
+	}
+
+	return obj;
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Recording
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Write the options which have changed since they were last written
+ */
+static void record_options(void)
+{
+	int i;
+
+	for (i = OPT_none + 1; i < OPT_MAX; i++) {
+		const char *name = option_name(i);
+
+		if (!name) continue;
+		if (record_opts_written && record_opts[i] == player->opts.opt[i])
+			continue;
+
+		record_opts[i] = player->opts.opt[i];
+		file_putf(record_file, "opt %s %s\n", name,
+			record_opts[i] ? "yes" : "no");
+	}
+	record_opts_written = true;
+}
+
+static void record_write_command(const struct command *cmd, cmd_context ctx)
+{
+	char place[40];
+	int i;
+
+	record_options();
+	file_putf(record_file, "cmd %d %d %d %d %d\n", (int) cmd->code,
+		(int) ctx, cmd->nrepeats, cmd->background_command, (int) turn);
+
+	for (i = 0; i < CMD_MAX_ARGS; i++) {
+		const struct cmd_arg *arg = &cmd->arg[i];
+
+		if (!arg->name[0] || arg->type == arg_NONE) continue;
+
+		file_putf(record_file, "arg %s %s ", arg->name,
+			arg_type_names[arg->type]);
+		switch (arg->type) {
+			case arg_STRING:
+				file_putf(record_file, "%s\n", arg->data.string);
+				break;
+			case arg_ITEM:
+				record_object_place(place, sizeof(place), arg->data.obj);
+				file_putf(record_file, "%s\n", place);
+				break;
+			case arg_POINT:
+				file_putf(record_file, "%d %d\n", arg->data.point.y,
+					arg->data.point.x);
+				break;
+			default:
+				file_putf(record_file, "%d\n", arg->data.number);
+				break;
+		}
+	}
+}
+
+static bool record_get_string(const char *prompt, char *buf, size_t len)
+{
+	bool answer = saved_hooks.get_string ?
+		saved_hooks.get_string(prompt, buf, len) : false;
+
+	file_putf(record_file, "ans string %d %s\n", answer ? 1 : 0,
+		answer ? buf : "");
+	return answer;
+}
+
+static int record_get_quantity(const char *prompt, int max)
+{
+	int answer = saved_hooks.get_quantity ?
+		saved_hooks.get_quantity(prompt, max) : 0;
+
+	file_putf(record_file, "ans quantity %d\n", answer);
+	return answer;
+}
+
+static bool record_get_check(const char *prompt)
+{
+	bool answer = saved_hooks.get_check ?
+		saved_hooks.get_check(prompt) : false;
+
+	file_putf(record_file, "ans check %d\n", answer ? 1 : 0);
+	return answer;
+}
+
+static bool record_get_com(const char *prompt, char *command)
+{
+	bool answer = saved_hooks.get_com ?
+		saved_hooks.get_com(prompt, command) : false;
+
+	file_putf(record_file, "ans com %d %d\n", answer ? 1 : 0,
+		answer ? (int) (unsigned char) *command : 0);
+	return answer;
+}
+
+static bool record_get_rep_dir(int *dir, bool allow_none)
+{
+	bool answer = saved_hooks.get_rep_dir ?
+		saved_hooks.get_rep_dir(dir, allow_none) : false;
+
+	file_putf(record_file, "ans rep_dir %d %d\n", answer ? 1 : 0, *dir);
+	return answer;
+}
+
+static bool record_get_aim_dir(int *dir)
+{
+	bool answer = saved_hooks.get_aim_dir ?
+		saved_hooks.get_aim_dir(dir) : false;
+
+	file_putf(record_file, "ans aim_dir %d %d\n", answer ? 1 : 0, *dir);
+	return answer;
+}
+
+static int record_get_spell_from_book(struct player *p, const char *verb,
+		struct object *book, const char *error,
+		bool (*spell_filter)(const struct player *p, int spell))
+{
+	int answer = saved_hooks.get_spell_from_book ?
+		saved_hooks.get_spell_from_book(p, verb, book, error,
+			spell_filter) : -1;
+
+	file_putf(record_file, "ans spell_from_book %d\n", answer);
+	return answer;
+}
+
+static int record_get_spell(struct player *p, const char *verb,
+		item_tester book_filter, cmd_code cmd, const char *book_error,
+		bool (*spell_filter)(const struct player *p, int spell),
+		const char *spell_error, struct object **rtn_book)
+{
+	char place[40];
+	int answer = saved_hooks.get_spell ?
+		saved_hooks.get_spell(p, verb, book_filter, cmd, book_error,
+			spell_filter, spell_error, rtn_book) : -1;
+
+	record_object_place(place, sizeof(place),
+		(answer >= 0 && rtn_book) ? *rtn_book : NULL);
+	file_putf(record_file, "ans spell %d %s\n", answer, place);
+	return answer;
+}
+
+static bool record_get_item(struct object **choice, const char *pmt,
+		const char *str, cmd_code cmd, item_tester tester, int mode)
+{
+	char place[40];
+	bool answer = saved_hooks.get_item ?
+		saved_hooks.get_item(choice, pmt, str, cmd, tester, mode) : false;
+
+	record_object_place(place, sizeof(place), answer ? *choice : NULL);
+	file_putf(record_file, "ans item %d %s\n", answer ? 1 : 0, place);
+	return answer;
+}
+
+static bool record_get_curse(int *choice, struct object *obj,
+		char *dice_string)
+{
+	bool answer = saved_hooks.get_curse ?
+		saved_hooks.get_curse(choice, obj, dice_string) : false;
+
+	file_putf(record_file, "ans curse %d %d\n", answer ? 1 : 0,
+		answer ? *choice : 0);
+	return answer;
+}
+
+static int record_get_effect_from_list(const char *prompt,
+		struct effect *effect, int count, bool allow_random)
+{
+	int answer = saved_hooks.get_effect_from_list ?
+		saved_hooks.get_effect_from_list(prompt, effect, count,
+			allow_random) : -1;
+
+	file_putf(record_file, "ans effect_from_list %d\n", answer);
+	return answer;
+}
+
+static bool record_confirm_debug(void)
+{
+	bool answer = saved_hooks.confirm_debug ?
+		saved_hooks.confirm_debug() : false;
+
+	file_putf(record_file, "ans confirm_debug %d\n", answer ? 1 : 0);
+	return answer;
+}
+
+static const struct input_hooks record_hooks = {
+	record_get_string,
+	record_get_quantity,
+	record_get_check,
+	record_get_com,
+	record_get_rep_dir,
+	record_get_aim_dir,
+	record_get_spell_from_book,
+	record_get_spell,
+	record_get_item,
+	record_get_curse,
+	record_get_effect_from_list,
+	record_confirm_debug
+};
+
+static void hooks_save(void)
+{
+	saved_hooks.get_string = get_string_hook;
+	saved_hooks.get_quantity = get_quantity_hook;
+	saved_hooks.get_check = get_check_hook;
+	saved_hooks.get_com = get_com_hook;
+	saved_hooks.get_rep_dir = get_rep_dir_hook;
+	saved_hooks.get_aim_dir = get_aim_dir_hook;
+	saved_hooks.get_spell_from_book = get_spell_from_book_hook;
+	saved_hooks.get_spell = get_spell_hook;
+	saved_hooks.get_item = get_item_hook;
+	saved_hooks.get_curse = get_curse_hook;
+	saved_hooks.get_effect_from_list = get_effect_from_list_hook;
+	saved_hooks.confirm_debug = confirm_debug_hook;
+}
+
+static void hooks_set(const struct input_hooks *hooks)
+{
+	get_string_hook = hooks->get_string;
+	get_quantity_hook = hooks->get_quantity;
+	get_check_hook = hooks->get_check;
+	get_com_hook = hooks->get_com;
+	get_rep_dir_hook = hooks->get_rep_dir;
+	get_aim_dir_hook = hooks->get_aim_dir;
+	get_spell_from_book_hook = hooks->get_spell_from_book;
+	get_spell_hook = hooks->get_spell;
+	get_item_hook = hooks->get_item;
+	get_curse_hook = hooks->get_curse;
+	get_effect_from_list_hook = hooks->get_effect_from_list;
+	confirm_debug_hook = hooks->confirm_debug;
+}
+
+/**
+ * Start recording the game to the file at path.  This has to be done before
+ * the character is made.
+ */
+bool record_start(const char *path)
+{
+	if (record_file) return false;
+
+	record_file = file_open(path, MODE_WRITE, FTYPE_TEXT);
+	if (!record_file) return false;
+
+	replaying = false;
+	record_seed = randint0(0x10000000);
+	record_count = 0;
+	record_opts_written = false;
+	file_putf(record_file, "# %s command record\n", buildid);
+	file_putf(record_file, "seed %08lx\n", (unsigned long) record_seed);
+
+	hooks_save();
+	hooks_set(&record_hooks);
+	return true;
+}
+
+/**
+ * Finish the record with the hash of the state the game is in now
+ */
+void record_stop(void)
+{
+	if (!record_file || replaying) return;
+
+	file_putf(record_file, "end %08lx\n", (unsigned long) game_state_hash());
+	file_close(record_file);
+	record_file = NULL;
+	hooks_set(&saved_hooks);
+}
+
+/**
+ * Note that the frontend has stopped a command being repeated, or the
+ * character running or resting
+ */
+void record_interrupt(void)
+{
+	if (!record_file || replaying) return;
+
+	file_putf(record_file, "interrupt %d\n", (int) turn);
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Replaying
+ * ------------------------------------------------------------------------ */
+
+static void replay_note(const char *what)
+{
+	if (replay_out_of_step) return;
+	replay_out_of_step = true;
+	plog_fmt("Replay out of step at line %d: %s", replay_line_num, what);
+}
+
+/**
+ * The next line of the record which isn't blank or a comment, or NULL at the
+ * end of the file
+ */
+static const char *replay_peek(void)
+{
+	while (!replay_line_read) {
+		if (!file_getl(record_file, replay_line, sizeof(replay_line))) {
+			replay_line_end = true;
+			break;
+		}
+		replay_line_num++;
+		if (replay_line[0] && replay_line[0] != '#') {
+			replay_line_read = true;
+		}
+	}
+	return replay_line_end ? NULL : replay_line;
+}
+
+static void replay_option(const char *line)
+{
+	char name[40];
+	int i;
+
+	my_strcpy(name, line + strlen("opt "), sizeof(name));
+	if (!strchr(name, ' ')) return;
+	*strchr(name, ' ') = '\0';
+
+	for (i = 0; i < OPT_MAX; i++) {
+		const char *opt = option_name(i);
+
+		if (opt && streq(opt, name)) {
+			player->opts.opt[i] = suffix(line, " yes");
+			return;
+		}
+	}
+}
+
+/**
+ * Find the next line of the given kind, and return the rest of it for
+ * strtok() to pick apart.  On the way, answers nothing asked for are passed
+ * over, unless the kind is an argument, and so are interrupts and options if
+ * the kind is a command; options are set when they are passed.  The frontend
+ * asks questions of its own, so answers being passed over doesn't mean the
+ * replay is out of step.  If another sort of line comes first, it is left for
+ * later and NULL returned.
+ *
+ * \param take is whether to move past the line found
+ */
+static char *replay_find(const char *kind, bool take)
+{
+	bool is_cmd = streq(kind, "cmd");
+	bool is_arg = streq(kind, "arg");
+	size_t len = strlen(kind);
+	const char *line;
+
+	while ((line = replay_peek())) {
+		if (prefix(line, kind) && (line[len] == ' ' || !line[len])) {
+			my_strcpy(replay_taken, line[len] ? line + len + 1 : "",
+				sizeof(replay_taken));
+			if (take) replay_line_read = false;
+			return replay_taken;
+		} else if (!is_arg && prefix(line, "ans ")) {
+			/* Asked by the frontend itself, as a store's menu does */
+		} else if (is_cmd && prefix(line, "interrupt ")) {
+			replay_note("interruption which didn't happen");
+		} else if (is_cmd && prefix(line, "opt ")) {
+			replay_option(line);
+		} else {
+			return NULL;
+		}
+		replay_line_read = false;
+	}
+
+	return NULL;
+}
+
+/**
+ * Put the next command of the record in the queue
+ *
+ * \param store_only is whether to do so only if it was done in a store
+ */
+static bool replay_push(bool store_only)
+{
+	char *rest = replay_find("cmd", false);
+	int code, ctx, nrepeats, background;
+
+	if (!rest) return false;
+	code = atoi(strtok(rest, " "));
+	ctx = replay_int();
+	nrepeats = replay_int();
+	background = replay_int();
+	if (store_only && ctx != CTX_STORE) return false;
+
+	if (cmdq_push_repeat(code, nrepeats)) {
+		replay_note("command which can't be queued");
+		return false;
+	}
+	cmdq_peek()->background_command = background;
+	return true;
+}
+
+static void replay_arg(struct command *cmd, char *rest)
+{
+	const char *name = strtok(rest, " ");
+	const char *type = strtok(NULL, " ");
+	const char *str;
+
+	if (!name || !type) return;
+
+	if (streq(type, "string")) {
+		str = strtok(NULL, "");
+		cmd_set_arg_string(cmd, name, str ? str : "");
+	} else if (streq(type, "choice")) {
+		cmd_set_arg_choice(cmd, name, replay_int());
+	} else if (streq(type, "item")) {
+		struct object *obj = replay_object();
+
+		/* Leave the command to ask, rather than act on nothing */
+		if (obj) {
+			cmd_set_arg_item(cmd, name, obj);
+		} else {
+			replay_note("object which isn't there");
+		}
+	} else if (streq(type, "number")) {
+		cmd_set_arg_number(cmd, name, replay_int());
+	} else if (streq(type, "direction")) {
+		cmd_set_arg_direction(cmd, name, replay_int());
+	} else if (streq(type, "target")) {
+		cmd_set_arg_target(cmd, name, replay_int());
+	} else if (streq(type, "point")) {
+		int y = replay_int();
+
+		cmd_set_arg_point(cmd, name, loc(replay_int(), y));
+	}
+}
+
+/**
+ * Check the command taken from the queue is the one in the record, and give
+ * it the arguments it had then
+ */
+static void replay_command(struct command *cmd)
+{
+	char *rest = replay_find("cmd", true);
+	int code, rturn;
+
+	if (!rest) {
+		replay_note("command which wasn't recorded");
+		return;
+	}
+
+	code = atoi(strtok(rest, " "));
+	(void) replay_int();
+	(void) replay_int();
+	(void) replay_int();
+	rturn = replay_int();
+	if (code != (int) cmd->code) {
+		replay_note("different command");
+	} else if (character_generated && rturn != turn) {
+		replay_note("command on a different turn");
+	}
+
+	while ((rest = replay_find("arg", true))) {
+		replay_arg(cmd, rest);
+	}
+}
+
+static bool replay_get_string(const char *prompt, char *buf, size_t len)
+{
+	char *rest = replay_find("ans string", true);
+
+	if (!rest) {
+		replay_note("string not recorded");
+		return false;
+	}
+	if (rest[0] != '1') return false;
+	my_strcpy(buf, rest[1] ? rest + 2 : "", len);
+	return true;
+}
+
+static int replay_get_quantity(const char *prompt, int max)
+{
+	char *rest = replay_find("ans quantity", true);
+
+	if (!rest) {
+		replay_note("quantity not recorded");
+		return 0;
+	}
+	return atoi(rest);
+}
+
+static bool replay_get_check(const char *prompt)
+{
+	char *rest = replay_find("ans check", true);
+
+	if (!rest) {
+		replay_note("check not recorded");
+		return false;
+	}
+	return atoi(rest) != 0;
+}
+
+static bool replay_get_com(const char *prompt, char *command)
+{
+	char *rest = replay_find("ans com", true);
+	bool answer;
+
+	if (!rest) {
+		replay_note("key not recorded");
+		return false;
+	}
+	answer = atoi(strtok(rest, " ")) != 0;
+	if (answer) *command = (char) replay_int();
+	return answer;
+}
+
+static bool replay_get_dir(const char *kind, int *dir)
+{
+	char *rest = replay_find(kind, true);
+	bool answer;
+
+	if (!rest) {
+		replay_note("direction not recorded");
+		return false;
+	}
+	answer = atoi(strtok(rest, " ")) != 0;
+	*dir = replay_int();
+	return answer;
+}
+
+static bool replay_get_rep_dir(int *dir, bool allow_none)
+{
+	return replay_get_dir("ans rep_dir", dir);
+}
+
+static bool replay_get_aim_dir(int *dir)
+{
+	return replay_get_dir("ans aim_dir", dir);
+}
+
+static int replay_get_spell_from_book(struct player *p, const char *verb,
+		struct object *book, const char *error,
+		bool (*spell_filter)(const struct player *p, int spell))
+{
+	char *rest = replay_find("ans spell_from_book", true);
+
+	if (!rest) {
+		replay_note("spell not recorded");
+		return -1;
+	}
+	return atoi(rest);
+}
+
+static int replay_get_spell(struct player *p, const char *verb,
+		item_tester book_filter, cmd_code cmd, const char *book_error,
+		bool (*spell_filter)(const struct player *p, int spell),
+		const char *spell_error, struct object **rtn_book)
+{
+	char *rest = replay_find("ans spell", true);
+	struct object *book;
+	int answer;
+
+	if (!rest) {
+		replay_note("spell not recorded");
+		return -1;
+	}
+	answer = atoi(strtok(rest, " "));
+	book = replay_object();
+	if (answer >= 0 && rtn_book) *rtn_book = book;
+	return answer;
+}
+
+static bool replay_get_item(struct object **choice, const char *pmt,
+		const char *str, cmd_code cmd, item_tester tester, int mode)
+{
+	char *rest = replay_find("ans item", true);
+	bool answer;
+
+	if (!rest) {
+		replay_note("item not recorded");
+		return false;
+	}
+	answer = atoi(strtok(rest, " ")) != 0;
+	*choice = replay_object();
+	return answer && *choice;
+}
+
+static bool replay_get_curse(int *choice, struct object *obj,
+		char *dice_string)
+{
+	char *rest = replay_find("ans curse", true);
+	bool answer;
+
+	if (!rest) {
+		replay_note("curse not recorded");
+		return false;
+	}
+	answer = atoi(strtok(rest, " ")) != 0;
+	*choice = replay_int();
+	return answer;
+}
+
+static int replay_get_effect_from_list(const char *prompt,
+		struct effect *effect, int count, bool allow_random)
+{
+	char *rest = replay_find("ans effect_from_list", true);
+
+	if (!rest) {
+		replay_note("effect not recorded");
+		return -1;
+	}
+	return atoi(rest);
+}
+
+static bool replay_confirm_debug(void)
+{
+	char *rest = replay_find("ans confirm_debug", true);
+
+	if (!rest) {
+		replay_note("debug command confirmation not recorded");
+		return false;
+	}
+	return atoi(rest) != 0;
+}
+
+static const struct input_hooks replay_hooks = {
+	replay_get_string,
+	replay_get_quantity,
+	replay_get_check,
+	replay_get_com,
+	replay_get_rep_dir,
+	replay_get_aim_dir,
+	replay_get_spell_from_book,
+	replay_get_spell,
+	replay_get_item,
+	replay_get_curse,
+	replay_get_effect_from_list,
+	replay_confirm_debug
+};
+
+/**
+ * Stop what the character is doing when the frontend did
+ */
+static void replay_interrupt(game_event_type type, game_event_data *data,
+		void *user)
+{
+	char *rest = replay_find("interrupt", false);
+
+	if (rest && atoi(rest) == turn) {
+		replay_line_read = false;
+		disturb(player);
+	}
+}
+
+/**
+ * Do what was done in a store, as the store's menu does
+ */
+static void replay_use_store(game_event_type type, game_event_data *data,
+		void *user)
+{
+	while (replay_push(true)) {
+		cmdq_pop(CTX_STORE);
+		notice_stuff(player);
+		handle_stuff(player);
+	}
+
+	/* Take a turn */
+	player->upkeep->energy_use = z_info->move_energy;
+}
+
+static void replay_leave_store(game_event_type type, game_event_data *data,
+		void *user)
+{
+	cmd_disable_repeat();
+	player->upkeep->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
+
+	/* The game has let go of our store handlers */
+	replay_store_visited = true;
+}
+
+static void replay_store_handlers(void)
+{
+	event_add_handler(EVENT_USE_STORE, replay_use_store, NULL);
+	event_add_handler(EVENT_LEAVE_STORE, replay_leave_store, NULL);
+	replay_store_visited = false;
+}
+
+/**
+ * Play the game recorded in the file at path again, with nothing but the
+ * record to answer for the player.  The game should have been initialised
+ * with init_angband(), but no character made.
+ *
+ * \param hash is set to the hash of the state the replay ended in.
+ * \return whether the replay kept in step with the record to the end, and
+ * ended with the same state.
+ */
+bool replay_game(const char *path, uint32_t *hash)
+{
+	const char *line;
+	char *rest;
+	unsigned int seed;
+	bool same = false;
+
+	*hash = 0;
+	if (record_file) return false;
+	record_file = file_open(path, MODE_READ, FTYPE_TEXT);
+	if (!record_file) return false;
+
+	replaying = true;
+	replay_line_read = false;
+	replay_line_end = false;
+	replay_line_num = 0;
+	replay_out_of_step = false;
+
+	line = replay_peek();
+	if (!line || sscanf(line, "seed %8x", &seed) != 1) {
+		plog_fmt("%s is not a command record", path);
+		file_close(record_file);
+		record_file = NULL;
+		replaying = false;
+		return false;
+	}
+	replay_line_read = false;
+	record_seed = seed;
+	record_count = 0;
+
+	hooks_save();
+	hooks_set(&replay_hooks);
+	event_add_handler(EVENT_CHECK_INTERRUPT, replay_interrupt, NULL);
+	replay_store_handlers();
+
+	/* Make the character */
+	character_generated = false;
+	while (!character_generated && replay_push(false)) {
+		cmdq_execute(CTX_BIRTH);
+	}
+
+	if (character_generated) {
+		/* Enter the game as the frontend would */
+		event_signal(EVENT_LEAVE_INIT);
+		event_signal(EVENT_ENTER_GAME);
+		event_signal(EVENT_ENTER_WORLD);
+		player->upkeep->autosave = false;
+		if (!character_dungeon) {
+			prepare_next_level(player);
+		}
+		on_new_level();
+
+		/* Stop playing where the record does */
+		while (!player->is_dead && player->upkeep->playing) {
+			if (replay_store_visited) replay_store_handlers();
+			if (!replay_push(false)) player->upkeep->playing = false;
+			run_game_loop();
+		}
+	}
+
+	*hash = game_state_hash();
+	rest = replay_find("end", true);
+	if (!rest && !replay_peek()) {
+		replay_note("the record stops before the game did");
+	} else if (!rest) {
+		replay_note("commands left over at the end");
+	} else if (strtoul(rest, NULL, 16) != *hash) {
+		replay_note("the game ended differently");
+	} else {
+		same = !replay_out_of_step;
+	}
+
+	event_remove_handler(EVENT_CHECK_INTERRUPT, replay_interrupt, NULL);
+	event_remove_handler(EVENT_USE_STORE, replay_use_store, NULL);
+	event_remove_handler(EVENT_LEAVE_STORE, replay_leave_store, NULL);
+	hooks_set(&saved_hooks);
+	file_close(record_file);
+	record_file = NULL;
+	replaying = false;
+	return same;
+}
+
+/**
+ * Called with each command the game takes from its queue, other than the
+ * repeats of one, to write it to the record, or to take its arguments from
+ * the record being replayed
+ */
+void record_command(struct command *cmd, cmd_context ctx)
+{
+	if (!record_file) return;
+
+	if (replaying) {
+		replay_command(cmd);
+	} else {
+		record_write_command(cmd, ctx);
+	}
+
+	/* Every command starts the random numbers afresh */
+	Rand_state_init(record_seed + record_count * 0x9E3779B9U);
+	record_count++;
+}
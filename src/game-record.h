@@ -0,0 +1,31 @@
+/**
+ * \file game-record.h
+ * \brief Record the commands of a game, and replay them without a display
+ *
+ * Copyright (c) 2026 Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+
+#include "cmd-core.h"
+
+bool record_start(const char *path);
+void record_stop(void);
+void record_command(struct command *cmd, cmd_context ctx);
+void record_interrupt(void);
+bool replay_game(const char *path, uint32_t *hash);
+uint32_t game_state_hash(void);
+
+#endif /* !GAME_RECORD_H */
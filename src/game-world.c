@@ -19,6 +19,7 @@
 #include "angband.h"
 #include "cmds.h"
 #include "effects.h"
+#include "game-profile.h"
 #include "game-world.h"
 #include "generate.h"
 #include "init.h"
@@ -368,6 +369,75 @@ static void decrease_timeouts(void)
 }
 
 
+/**
+ * Find how far from the player noise needs to be tracked on a level.
+ *
+ * Noise only matters up to the best hearing of any monster on the level, or
+ * to the range where noise disturbs sleeping monsters, if that is further.
+ * One more step is needed so that monsters at the limit of their hearing can
+ * compare the noise in the grids around them.
+ */
+static int noise_horizon(struct chunk *c, int noise_increment)
+{
+	int i, hearing = MON_WAKE_NOISE;
+
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+
+		if (mon->race && mon->race->hearing > hearing) {
+			hearing = mon->race->hearing;
+		}
+	}
+
+	return hearing + noise_increment;
+}
+
+/**
+ * Check the noise field against a full, unbounded recomputation.
+ * \return the number of grids which differ within earshot or are not silent
+ * beyond it.
+ */
+int check_noise(struct chunk *c, struct player *p)
+{
+	uint16_t *full = mem_zalloc(c->height * c->width * sizeof(*full));
+	struct queue *queue = q_new(c->height * c->width);
+	struct loc next = p->grid;
+	int noise_increment = p->timed[TMD_COVERTRACKS] ? 4 : 1;
+	int horizon = noise_horizon(c, noise_increment);
+	int d, n = 0, bad = 0;
+
+	/* Propagate noise over the whole level, as far as it will go */
+	q_push_int(queue, grid_to_i(next, c->width));
+	while (q_len(queue) > 0) {
+		int noise;
+
+		i_to_grid(q_pop_int(queue), c->width, &next);
+		noise = full[grid_to_i(next, c->width)] + noise_increment;
+		for (d = 0; d < 8; d++)	{
+			struct loc grid = loc_sum(next, ddgrid_ddd[d]);
+
+			if (!square_in_bounds(c, grid)) continue;
+			if (square_isnoflow(c, grid)) continue;
+			if (full[grid_to_i(grid, c->width)] != 0) continue;
+			if (loc_eq(p->grid, grid)) continue;
+			full[grid_to_i(grid, c->width)] = noise;
+			q_push_int(queue, grid_to_i(grid, c->width));
+		}
+	}
+
+	/* Compare */
+	for (n = 0; n < c->height * c->width; n++) {
+		int expect = (full[n] <= horizon) ? full[n] : 0;
+
+		i_to_grid(n, c->width, &next);
+		if (c->noise.grids[next.y][next.x] != expect) bad++;
+	}
+
+	q_free(queue);
+	mem_free(full);
+	return bad;
+}
+
 /**
  * Every turn, the character makes enough noise that nearby monsters can use
  * it to home in.
@@ -383,64 +453,87 @@ static void decrease_timeouts(void)
  * values, thereby homing in on the player even though twisty tunnels and
  * mazes.  Monsters have a hearing value, which is the largest sound value
  * they can detect.
+ *
+ * Noise is only propagated as far as noise_horizon(), so grids out of earshot
+ * of every monster on the level are left silent.  The grids reached are kept
+ * in order in the chunk's noise list, which serves as the queue for the
+ * propagation and, next time, as the list of grids to silence again; so the
+ * work done each turn depends on the area within earshot rather than on the
+ * size of the level.
+ *
+ * The field is filled again each turn rather than patched where the player
+ * moved from: a step of one grid changes the distance to nearly every grid
+ * in earshot, so patching would visit the same grids with more bookkeeping.
  */
-static void make_noise(struct player *p)
+void make_noise(struct player *p)
 {
+	struct chunk *c = cave;
 	struct loc next = p->grid;
-	int y, x, d;
-	int noise = 0;
+	int d, head;
 	int noise_increment = p->timed[TMD_COVERTRACKS] ? 4 : 1;
-    struct queue *queue = q_new(cave->height * cave->width);
+	int horizon = noise_horizon(c, noise_increment);
 
-	/* Set all the grids to silence */
-	for (y = 1; y < cave->height - 1; y++) {
-		for (x = 1; x < cave->width - 1; x++) {
-			cave->noise.grids[y][x] = 0;
-		}
+	profile_enter(PROFILE_NOISE);
+	if (!c->noise_list) {
+		c->noise_list = mem_alloc(c->height * c->width
+			* sizeof(*c->noise_list));
+		c->noise_count = 0;
+	}
+
+	/* Set the grids which had noise last time back to silence */
+	for (head = 0; head < c->noise_count; head++) {
+		i_to_grid(c->noise_list[head], c->width, &next);
+		c->noise.grids[next.y][next.x] = 0;
 	}
+	c->noise_count = 0;
 
 	/* Player makes noise */
-	cave->noise.grids[next.y][next.x] = noise;
-	q_push_int(queue, grid_to_i(next, cave->width));
-	noise += noise_increment;
+	next = p->grid;
+	c->noise.grids[next.y][next.x] = 0;
+	c->noise_list[c->noise_count++] = grid_to_i(next, c->width);
 
 	/* Propagate noise */
-	while (q_len(queue) > 0) {
+	for (head = 0; head < c->noise_count; head++) {
+		int noise;
+
 		/* Get the next grid */
-		i_to_grid(q_pop_int(queue), cave->width, &next);
+		i_to_grid(c->noise_list[head], c->width, &next);
+		noise = c->noise.grids[next.y][next.x] + noise_increment;
 
-		/* If we've reached the current noise level, put it back and step */
-		if (cave->noise.grids[next.y][next.x] == noise) {
-			q_push_int(queue, grid_to_i(next, cave->width));
-			noise += noise_increment;
-			continue;
-		}
+		/* Stop once out of earshot */
+		if (noise > horizon) break;
 
 		/* Assign noise to the children and enqueue them */
 		for (d = 0; d < 8; d++)	{
 			/* Child location */
 			struct loc grid = loc_sum(next, ddgrid_ddd[d]);
 
-			if (!square_in_bounds(cave, grid)) continue;
+			if (!square_in_bounds(c, grid)) continue;
 
 			/* Ignore features that don't transmit sound */
-			if (square_isnoflow(cave, grid)) continue;
+			if (square_isnoflow(c, grid)) continue;
 
 			/* Skip grids that already have noise */
-			if (cave->noise.grids[grid.y][grid.x] != 0) continue;
+			if (c->noise.grids[grid.y][grid.x] != 0) continue;
 
 			/* Skip the player grid */
 			if (loc_eq(p->grid, grid)) continue;
 
 			/* Save the noise */
-			cave->noise.grids[grid.y][grid.x] = noise;
+			c->noise.grids[grid.y][grid.x] = noise;
 
 			/* Enqueue that entry */
-			q_push_int(queue, grid_to_i(grid, cave->width));
+			c->noise_list[c->noise_count++] = grid_to_i(grid, c->width);
 		}
 	}
 
-	q_free(queue);
+#ifdef NOISE_DEBUG
+	d = check_noise(c, p);
+	if (d) {
+		msg("Noise differs from a full recompute in %d grids.", d);
+	}
+#endif
+	profile_leave(PROFILE_NOISE);
 }
 
 /**
@@ -456,8 +549,12 @@ static void make_noise(struct player *p)
  * value which indicates the oldest scent they can detect.  Grids where the
  * player has never been will have scent 0.  The player's grid will also have
  * scent 0, but this is OK as no monster will ever be smelling it.
+ *
+ * Aging is done by advancing the chunk's scent count, which ages every grid
+ * at once (see square_scent()), so only the grids around the player are
+ * touched here.
  */
-static void update_scent(void)
+void update_scent(struct chunk *c, struct player *p)
 {
 	int y, x;
 	int scent_strength[5][5] = {
@@ -468,17 +565,11 @@ static void update_scent(void)
 		{2, 2, 2, 2, 2},
 	};
 
-	/* Update scent for all grids */
-	for (y = 1; y < cave->height - 1; y++) {
-		for (x = 1; x < cave->width - 1; x++) {
-			if (cave->scent.grids[y][x] > 0) {
-				cave->scent.grids[y][x]++;
-			}
-		}
-	}
+	/* Age the scent in all grids */
+	c->scent.count++;
 
 	/* Scentless player */
-	if (player->timed[TMD_COVERTRACKS]) return;
+	if (p->timed[TMD_COVERTRACKS]) return;
 
 	/* Lay down new scent around the player */
 	for (y = 0; y < 5; y++) {
@@ -489,18 +580,18 @@ static void update_scent(void)
 			bool add_scent = false;
 
 			/* Initialize */
-			scent.y = y + player->grid.y - 2;
-			scent.x = x + player->grid.x - 2;
+			scent.y = y + p->grid.y - 2;
+			scent.x = x + p->grid.x - 2;
 
 			/* Ignore invalid or non-scent-carrying grids */
-			if (!square_in_bounds(cave, scent)) continue;
-			if (square_isnoscent(cave, scent)) continue;
+			if (!square_in_bounds(c, scent)) continue;
+			if (square_isnoscent(c, scent)) continue;
 
 			/* Check scent is spreading on floors, not going through walls */
 			for (d = 0; d < 8; d++)	{
 				struct loc adj = loc_sum(scent, ddgrid_ddd[d]);
 
-				if (!square_in_bounds(cave, adj)) {
+				if (!square_in_bounds(c, adj)) {
 					continue;
 				}
 
@@ -510,7 +601,7 @@ static void update_scent(void)
 				}
 
 				/* Adjacent to a closer grid, so valid */
-				if (cave->scent.grids[adj.y][adj.x] == new_scent - 1) {
+				if (square_scent(c, adj) == new_scent - 1) {
 					add_scent = true;
 				}
 			}
@@ -521,7 +612,8 @@ static void update_scent(void)
 			}
 
 			/* Mark the scent */
-			cave->scent.grids[scent.y][scent.x] = new_scent;
+			c->scent.grids[scent.y][scent.x] = new_scent ?
+				c->scent.count - new_scent : 0;
 		}
 	}
 }
@@ -731,7 +823,7 @@ void process_world(struct chunk *c)
 	/* Update noise and scent (not if resting) */
 	if (!player_is_resting(player)) {
 		make_noise(player);
-		update_scent();
+		update_scent(cave, player);
 	}
 
 
@@ -1001,6 +1093,9 @@ void process_player(void)
  */
 void on_new_level(void)
 {
+	/* Only visit monsters when they can move */
+	schedule_monsters(cave);
+
 	/* Arena levels are not really a level change */
 	if (!player->upkeep->arena_level) {
 		/* Play ambient sound on change of level. */
@@ -1061,6 +1156,9 @@ void on_new_level(void)
  * Housekeeping on leaving a level
  */
 static void on_leave_level(void) {
+	/* Settle the monsters' energy before the level is stored */
+	unschedule_monsters(cave);
+
 	/* Cancel any command */
 	player_clear_timed(player, TMD_COMMAND, false, false);
 
@@ -1091,7 +1189,9 @@ void run_game_loop(void)
 	/* Keep processing the player until they use some energy or
 	 * another command is needed */
 	while (player->upkeep->playing) {
+		profile_enter(PROFILE_PLAYER);
 		process_player();
+		profile_leave(PROFILE_PLAYER);
 		if (player->upkeep->energy_use)
 			break;
 		else
@@ -1112,7 +1212,9 @@ void run_game_loop(void)
 
 		/* Process the player until they use some energy */
 		while (player->upkeep->playing) {
+			profile_enter(PROFILE_PLAYER);
 			process_player();
+			profile_leave(PROFILE_PLAYER);
 			if (player->upkeep->energy_use)
 				break;
 			else
@@ -1148,7 +1250,9 @@ void run_game_loop(void)
 
 			/* Process the world every ten turns */
 			if (!(turn % 10) && !player->upkeep->generate_level) {
+				profile_enter(PROFILE_WORLD);
 				process_world(cave);
+				profile_leave(PROFILE_WORLD);
 
 				/* Refresh */
 				notice_stuff(player);
@@ -1203,7 +1307,9 @@ void run_game_loop(void)
 
 			/* Process the player until they use some energy */
 			while (player->upkeep->playing) {
+				profile_enter(PROFILE_PLAYER);
 				process_player();
+				profile_leave(PROFILE_PLAYER);
 				if (player->upkeep->energy_use)
 					break;
 				else
@@ -43,6 +43,9 @@ struct level *level_by_depth(int depth);
 bool is_daytime(void);
 int turn_energy(int speed);
 void play_ambient_sound(void);
+void make_noise(struct player *p);
+int check_noise(struct chunk *c, struct player *p);
+void update_scent(struct chunk *c, struct player *p);
 void process_world(struct chunk *c);
 void on_new_level(void);
 void process_player(void);
@@ -2674,6 +2674,7 @@ struct chunk *town_gen(struct player *p, int min_height, int min_width,
 		town_gen_layout(c_new, p);
 	} else {
 		/* Copy from the chunk list, remove the old one */
+		cave_unpack(c_old);
 		c_new->depth = c_old->depth;
 		if (!chunk_copy(c_new, p, c_old, 0, 0, 0, 0))
 			quit_fmt("chunk_copy() level bounds failed!");
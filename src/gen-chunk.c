@@ -61,9 +61,52 @@ struct chunk *chunk_write(struct chunk *c)
 	return new;
 }
 
+/**
+ * Open-addressed table of the stored chunks by name, which is rebuilt
+ * whenever the list is shortened or found to be out of step with it
+ */
+static struct chunk **chunk_table;
+static size_t chunk_table_size;
+static int chunk_table_count;
+
+#define CHUNK_TABLE_INIT 32
+
+/**
+ * Find the slot in the chunk table for 'name'; it holds either the chunk
+ * with that name or NULL.
+ */
+static size_t chunk_table_slot(const char *name)
+{
+	size_t mask = chunk_table_size - 1;
+	size_t i = djb2_hash(name) & mask;
+
+	while (chunk_table[i] && !streq(chunk_table[i]->name, name))
+		i = (i + 1) & mask;
+	return i;
+}
+
+/**
+ * Index every chunk on the list, with room for at least one more
+ */
+static void chunk_table_rebuild(void)
+{
+	int i;
+
+	chunk_table_size = CHUNK_TABLE_INIT;
+	while ((size_t) (chunk_list_max + 1) * 2 > chunk_table_size)
+		chunk_table_size *= 2;
+	mem_free(chunk_table);
+	chunk_table = mem_zalloc(chunk_table_size * sizeof(*chunk_table));
+	for (i = 0; i < chunk_list_max; i++)
+		chunk_table[chunk_table_slot(chunk_list[i]->name)] = chunk_list[i];
+	chunk_table_count = chunk_list_max;
+}
+
 /**
  * Add an entry to the chunk list - any problems with the length of this will
- * be more in the memory used by the chunks themselves rather than the list
+ * be more in the memory used by the chunks themselves rather than the list.
+ * The chunk's squares are packed away until it is taken off the list or
+ * unpacked by its user.
  * \param c the chunk being added to the list
  */
 void chunk_list_add(struct chunk *c)
@@ -74,12 +117,21 @@ void chunk_list_add(struct chunk *c)
 	if ((chunk_list_max % CHUNK_LIST_INCR) == 0)
 		chunk_list = (struct chunk **) mem_realloc(chunk_list, newsize);
 
+	/* Index it, keeping the table at most half full */
+	if (!chunk_table || chunk_table_count != chunk_list_max ||
+			(size_t) (chunk_list_max + 1) * 2 > chunk_table_size)
+		chunk_table_rebuild();
+	chunk_table[chunk_table_slot(c->name)] = c;
+	chunk_table_count++;
+
 	/* Add the new one */
 	chunk_list[chunk_list_max++] = c;
+	cave_pack(c);
 }
 
 /**
- * Remove an entry from the chunk list, return whether it was found
+ * Remove an entry from the chunk list, return whether it was found; the
+ * chunk is unpacked, ready for use
  * \param name the name of the chunk being removed from the list
  * \return whether it was found; success means it was successfully removed
  */
@@ -90,8 +142,19 @@ bool chunk_list_remove(const char *name)
 	/* Find the match */
 	for (i = 0; i < chunk_list_max; i++) {
 		if (streq(name, chunk_list[i]->name)) {
-			/* Copy all the succeeding chunks back one */
 			int j;
+
+			/*
+			 * It is about to change, so the saved copy is stale once
+			 * the squares have been read back from it
+			 */
+			cave_unpack(chunk_list[i]);
+			mem_free(chunk_list[i]->saved);
+			chunk_list[i]->saved = NULL;
+			chunk_list[i]->saved_len = 0;
+			chunk_list[i]->saved_squares = 0;
+
+			/* Copy all the succeeding chunks back one */
 			for (j = i + 1; j < chunk_list_max; j++) {
 				chunk_list[j - 1] = chunk_list[j];
 			}
@@ -99,6 +162,7 @@ bool chunk_list_remove(const char *name)
 			/* Shorten the list and return */
 			chunk_list_max--;
 			chunk_list[chunk_list_max] = NULL;
+			chunk_table_rebuild();
 			return true;
 		}
 	}
@@ -107,19 +171,40 @@ bool chunk_list_remove(const char *name)
 }
 
 /**
- * Find a chunk by name
+ * Find a chunk by name.  The chunk may still be packed, so only its name,
+ * size, depth, connectors and the like can be used until cave_unpack() is
+ * called on it.
  * \param name the name of the chunk being sought
  * \return the pointer to the chunk
  */
 struct chunk *chunk_find_name(const char *name)
 {
-	int i;
+	if (!chunk_list_max) return NULL;
+	if (!chunk_table || chunk_table_count != chunk_list_max)
+		chunk_table_rebuild();
+	return chunk_table[chunk_table_slot(name)];
+}
 
-	for (i = 0; i < chunk_list_max; i++)
-		if (streq(name, chunk_list[i]->name))
-			return chunk_list[i];
+/**
+ * Free all the stored chunks
+ */
+void chunk_list_free(struct player *p)
+{
+	int i;
 
-	return NULL;
+	for (i = 0; i < chunk_list_max; i++) {
+		/* Wiping the monsters needs the squares */
+		cave_unpack(chunk_list[i]);
+		wipe_mon_list(chunk_list[i], p);
+		cave_free(chunk_list[i]);
+	}
+	mem_free(chunk_list);
+	chunk_list = NULL;
+	chunk_list_max = 0;
+	mem_free(chunk_table);
+	chunk_table = NULL;
+	chunk_table_size = 0;
+	chunk_table_count = 0;
 }
 
 /**
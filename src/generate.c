@@ -32,6 +32,7 @@
 #include "datafile.h"
 #include "game-event.h"
 #include "game-input.h"
+#include "game-profile.h"
 #include "game-world.h"
 #include "generate.h"
 #include "init.h"
@@ -1336,6 +1337,8 @@ void prepare_next_level(struct player *p)
 {
 	bool persist = OPT(p, birth_levels_persist) || p->upkeep->arena_level;
 
+	profile_enter(PROFILE_GENERATE);
+
 	/* Deal with any existing current level */
 	if (character_dungeon) {
 		assert (p->cave);
@@ -1409,6 +1412,8 @@ void prepare_next_level(struct player *p)
 			char *known_name = string_make(format("%s known", name));
 			struct chunk *old_known = chunk_find_name(known_name);
 			assert(old_known);
+			cave_unpack(old_level);
+			cave_unpack(old_known);
 
 			/* Assign the new ones */
 			cave = old_level;
@@ -1541,6 +1546,7 @@ void prepare_next_level(struct player *p)
 
 	/* The dungeon is ready */
 	character_dungeon = true;
+	profile_leave(PROFILE_GENERATE);
 }
 
 /**
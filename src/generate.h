@@ -351,6 +351,7 @@ struct chunk *chunk_write(struct chunk *c);
 void chunk_list_add(struct chunk *c);
 bool chunk_list_remove(const char *name);
 struct chunk *chunk_find_name(const char *name);
+void chunk_list_free(struct player *p);
 bool chunk_find(struct chunk *c);
 struct chunk *chunk_find_adjacent(int depth, bool above);
 void symmetry_transform(struct loc *grid, int y0, int x0, int height, int width,
@@ -4431,6 +4431,8 @@ static struct init_module arrays_module = {
 
 extern struct init_module z_quark_module;
 extern struct init_module generate_module;
+extern struct init_module los_module;
+extern struct init_module project_path_module;
 extern struct init_module rune_module;
 extern struct init_module obj_make_module;
 extern struct init_module ignore_module;
@@ -4449,6 +4451,8 @@ static struct init_module *modules[] = {
 	&arrays_module,
 	&player_module,
 	&generate_module,
+	&los_module,
+	&project_path_module,
 	&rune_module,
 	&obj_make_module,
 	&ignore_module,
@@ -4509,12 +4513,7 @@ void cleanup_angband(void)
 	int i;
 
 	/* Free the chunk list */
-	for (i = 0; i < chunk_list_max; i++) {
-		wipe_mon_list(chunk_list[i], player);
-		cave_free(chunk_list[i]);
-	}
-	mem_free(chunk_list);
-	chunk_list = NULL;
+	chunk_list_free(player);
 
 	for (i = 0; modules[i]; i++)
 		if (modules[i]->cleanup)
@@ -171,8 +171,7 @@ static struct object *rd_item(void)
 	}
 	rd_byte(&obj->notice);
 
-	for (i = 0; i < of_size; i++)
-		rd_byte(&obj->flags[i]);
+	rd_bytes(obj->flags, of_size);
 
 	for (i = 0; i < obj_mod_max; i++) {
 		rd_s16b(&obj->modifiers[i]);
@@ -295,11 +294,9 @@ static bool rd_monster(struct chunk *c, struct monster *mon)
 		rd_s16b(&mon->m_timed[j]);
 
 	/* Read and extract the flag */
-	for (j = 0; j < mflag_size; j++)
-		rd_byte(&mon->mflag[j]);
+	rd_bytes(mon->mflag, mflag_size);
 
-	for (j = 0; j < of_size; j++)
-		rd_byte(&mon->known_pstate.flags[j]);
+	rd_bytes(mon->known_pstate.flags, of_size);
 
 	for (j = 0; j < elem_max; j++)
 		rd_s16b(&mon->known_pstate.el_info[j].res_level);
@@ -358,7 +355,6 @@ static bool rd_monster(struct chunk *c, struct monster *mon)
  */
 static void rd_trap(struct trap *trap)
 {
-	int i;
 	uint8_t tmp8u;
 	char buf[80];
 
@@ -374,8 +370,7 @@ static void rd_trap(struct trap *trap)
 	rd_byte(&trap->power);
 	rd_byte(&trap->timeout);
 
-	for (i = 0; i < trf_size; i++)
-		rd_byte(&trap->flags[i]);
+	rd_bytes(trap->flags, trf_size);
 }
 
 /**
@@ -1261,6 +1256,24 @@ static int rd_stores_aux(rd_item_t rd_item_version)
 int rd_stores(void) { return rd_stores_aux(rd_item); }
 
 
+/**
+ * Read one layer of the level, n grids in row order, from (count, value) runs
+ */
+static void rd_layer_rle(uint8_t *layer, size_t n)
+{
+	size_t filled = 0;
+	uint8_t run[2];
+
+	while (filled < n) {
+		size_t count;
+
+		rd_bytes(run, sizeof(run));
+		count = MIN((size_t) run[0], n - filled);
+		memset(layer + filled, run[1], count);
+		filled += count;
+	}
+}
+
 /**
  * Read the dungeon
  *
@@ -1281,11 +1294,12 @@ int rd_stores(void) { return rd_stores_aux(rd_item); }
 static int rd_dungeon_aux(struct chunk **c)
 {
 	struct chunk *c1;
-	int i, n, y, x;
+	int n, y, x;
+	size_t grids;
+	uint8_t *layer;
 
 	uint16_t height, width;
 
-	uint8_t count;
 	uint8_t tmp8u;
 	uint16_t tmp16u;
 	char name[100];
@@ -1301,54 +1315,27 @@ static int rd_dungeon_aux(struct chunk **c)
 	/* We need a cave struct */
 	c1 = cave_new(height, width);
 	c1->name = string_make(name);
+	grids = (size_t) height * width;
+	layer = mem_alloc(MAX(grids, 1));
 
-    /* Run length decoding of cave->squares[y][x].info */
+	/* Run length decoding of cave->squares[y][x].info */
 	for (n = 0; n < square_size; n++) {
-		/* Load the dungeon data */
-		for (x = y = 0; y < c1->height; ) {
-			/* Grab RLE info */
-			rd_byte(&count);
-			rd_byte(&tmp8u);
-
-			/* Apply the RLE info */
-			for (i = count; i > 0; i--) {
-				/* Extract "info" */
-				c1->squares[y][x].info[n] = tmp8u;
-
-				/* Advance/Wrap */
-				if (++x >= c1->width) {
-					/* Wrap */
-					x = 0;
-
-					/* Advance/Wrap */
-					if (++y >= c1->height) break;
-				}
+		rd_layer_rle(layer, grids);
+		for (y = 0; y < c1->height; y++) {
+			for (x = 0; x < c1->width; x++) {
+				c1->squares[y][x].info[n] = layer[y * c1->width + x];
 			}
 		}
 	}
 
 	/* Run length decoding of dungeon data */
-	for (x = y = 0; y < c1->height; ) {
-		/* Grab RLE info */
-		rd_byte(&count);
-		rd_byte(&tmp8u);
-
-		/* Apply the RLE info */
-		for (i = count; i > 0; i--) {
-			/* Extract "feat" */
-			square_set_feat(c1, loc(x, y), tmp8u);
-
-			/* Advance/Wrap */
-			if (++x >= c1->width) {
-				/* Wrap */
-				x = 0;
-
-				/* Advance/Wrap */
-				if (++y >= c1->height) break;
-			}
+	rd_layer_rle(layer, grids);
+	for (y = 0; y < c1->height; y++) {
+		for (x = 0; x < c1->width; x++) {
+			square_set_feat(c1, loc(x, y), layer[y * c1->width + x]);
 		}
 	}
-
+	mem_free(layer);
 
 	/* Read "feeling" */
 	rd_byte(&tmp8u);
@@ -1367,9 +1354,7 @@ static int rd_dungeon_aux(struct chunk **c)
 			rd_byte(&tmp8u);
 			current->grid.y = tmp8u;
 			rd_byte(&current->feat);
-			for (n = 0; n < square_size; n++) {
-				rd_byte(&current->info[n]);
-			}
+			rd_bytes(current->info, square_size);
 			current->next = c1->join;
 			c1->join = current;
 			rd_byte(&tmp8u);
@@ -21,6 +21,7 @@
 #ifdef USE_STATS
 
 #include "buildid.h"
+#include "game-profile.h"
 #include "game-world.h"
 #include "generate.h"
 #include "init.h"
@@ -1756,6 +1757,9 @@ errr init_stats(int argc, char *argv[]) {
 		printf("init-stats: bad argument '%s'\n", argv[i]);
 	}
 
+	/* Nobody is there to ask for the profile, so write it on the way out */
+	profile_dump_at_exit();
+
 	term_data_link(0);
 	return 0;
 }
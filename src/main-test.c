@@ -18,6 +18,7 @@
 
 #include "angband.h"
 #include "buildid.h"
+#include "game-profile.h"
 #include "main.h"
 #include "player.h"
 #include "player-birth.h"
@@ -316,6 +317,9 @@ errr init_test(int argc, char *argv[]) {
 	 */
 	savefile[0] = '\0';
 
+	/* Nobody is there to ask for the profile, so write it on the way out */
+	profile_dump_at_exit();
+
 	term_data_link(0);
 	return 0;
 }
@@ -17,6 +17,8 @@
  */
 
 #include "angband.h"
+#include "game-profile.h"
+#include "game-record.h"
 #include "init.h"
 #include "savefile.h"
 #include "ui-birth.h"
@@ -322,6 +324,7 @@ int main(int argc, char *argv[])
 	bool done = false;
 
 	const char *mstr = NULL;
+	const char *replayfile = NULL;
 	bool args = true;
 
 	/* Save the "program name" XXX XXX XXX */
@@ -412,6 +415,16 @@ int main(int argc, char *argv[])
 				arg_force_name = true;
 				break;
 
+			case 'r':
+				if (!*arg) goto usage;
+				my_strcpy(recordfile, arg, sizeof(recordfile));
+				continue;
+
+			case 'R':
+				if (!*arg) goto usage;
+				replayfile = arg;
+				continue;
+
 			case 'm':
 				if (!*arg) goto usage;
 				mstr = arg;
@@ -441,6 +454,8 @@ int main(int argc, char *argv[])
 				puts("  -l             Lists all savefiles you can play");
 				puts("  -w             Resurrect dead character (marks savefile)");
 				puts("  -g             Request graphics mode");
+				puts("  -r<file>       Start a new character and record the game to <file>");
+				puts("  -R<file>       Replay the game recorded in <file> without a display");
 				puts("  -u<who>        Use your <who> savefile");
 				puts("  -d<dir>=<path> Override a specific directory with <path>. <path> can be:");
 				for (i = 0; i < (int)N_ELEMENTS(change_path_values); i++) {
@@ -502,6 +517,23 @@ int main(int argc, char *argv[])
 
 #endif /* UNIX */
 
+	/* Replay a recorded game as fast as it will go, and stop */
+	if (replayfile) {
+		uint32_t hash;
+		bool same;
+
+		/* Don't touch the character's savefile */
+		savefile[0] = '\0';
+
+		profile_dump_at_exit();
+		init_angband();
+		same = replay_game(replayfile, &hash);
+		printf("Replay of %s ended with state hash %08lx, %s\n", replayfile,
+			(unsigned long) hash, same ? "as recorded" : "not as recorded");
+		cleanup_angband();
+		quit(same ? NULL : "The replay did not match the record");
+	}
+
 	/* Try the modules in the order specified by modules[] */
 	for (i = 0; i < (int)N_ELEMENTS(modules); i++) {
 		/* User requested a specific module? */
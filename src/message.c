@@ -37,8 +37,7 @@
 typedef struct _message_t
 {
 	char *str;
-	struct _message_t *newer;
-	struct _message_t *older;
+	size_t size;
 	uint16_t type;
 	uint16_t count;
 } message_t;
@@ -50,10 +49,16 @@ typedef struct _msgcolor_t
 	struct _msgcolor_t *next;
 } msgcolor_t;
 
+/**
+ * The messages are a ring of max entries, of which the count most recent are
+ * in use; newest is the slot of the latest one.  Each slot keeps its text
+ * buffer when its message is pushed out, so a new message only allocates
+ * when its text is longer than anything the slot has held before.
+ */
 typedef struct _msgqueue_t
 {
-	message_t *head;
-	message_t *tail;
+	message_t *ring;
+	uint32_t newest;
 	msgcolor_t *colors;
 	uint32_t count;
 	uint32_t max;
@@ -73,6 +78,7 @@ void messages_init(void)
 {
 	messages = mem_zalloc(sizeof(msgqueue_t));
 	messages->max = 2048;
+	messages->ring = mem_zalloc(messages->max * sizeof(message_t));
 }
 
 /**
@@ -82,15 +88,11 @@ void messages_free(void)
 {
 	msgcolor_t *c = messages->colors;
 	msgcolor_t *nextc;
-	message_t *m = messages->head;
-	message_t *nextm;
-
-	while (m) {
-		nextm = m->older;
-		mem_free(m->str);
-		mem_free(m);
-		m = nextm;
-	}
+	uint32_t i;
+
+	for (i = 0; i < messages->max; i++)
+		mem_free(messages->ring[i].str);
+	mem_free(messages->ring);
 
 	while (c) {
 		nextc = c->next;
@@ -123,40 +125,32 @@ uint16_t messages_num(void)
  */
 void message_add(const char *str, uint16_t type)
 {
-	message_t *m;
-
-	if (messages->head &&
-	    messages->head->type == type &&
-	    streq(messages->head->str, str) &&
-	    messages->head->count != (uint16_t)-1) {
-		messages->head->count++;
+	message_t *m = messages->count ? &messages->ring[messages->newest] : NULL;
+	size_t size;
+
+	if (m &&
+	    m->type == type &&
+	    streq(m->str, str) &&
+	    m->count != (uint16_t)-1) {
+		m->count++;
 		return;
 	}
 
-	m = mem_zalloc(sizeof(message_t));
-	m->str = string_make(str);
+	/* Take the next slot, pushing out the oldest message if it is full */
+	if (messages->count)
+		messages->newest = (messages->newest + 1) % messages->max;
+	if (messages->count < messages->max)
+		messages->count++;
+	m = &messages->ring[messages->newest];
+
+	size = strlen(str) + 1;
+	if (size > m->size) {
+		m->str = mem_realloc(m->str, size);
+		m->size = size;
+	}
+	memcpy(m->str, str, size);
 	m->type = type;
 	m->count = 1;
-	m->older = messages->head;
-
-	if (messages->head)
-		messages->head->newer = m;
-
-	messages->head = m;
-	messages->count++;
-
-	if (!messages->tail)
-		messages->tail = m;
-
-	if (messages->count > messages->max) {
-		message_t *old_tail = messages->tail;
-
-		messages->tail = old_tail->newer;
-		messages->tail->older = NULL;
-		mem_free(old_tail->str);
-		mem_free(old_tail);
-		messages->count--;
-	}
 }
 
 /**
@@ -164,14 +158,11 @@ void message_add(const char *str, uint16_t type)
  */
 static message_t *message_get(uint16_t age)
 {
-	message_t *m = messages->head;
-
-	while (m && age) {
-		age--;
-		m = m->older;
-	}
+	if (age >= messages->count)
+		return NULL;
 
-	return m;
+	return &messages->ring[(messages->newest + messages->max - age)
+		% messages->max];
 }
 
 
@@ -23,6 +23,7 @@
 #include "mon-group.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-predicate.h"
 #include "mon-timed.h"
 #include "mon-util.h"
@@ -46,13 +47,39 @@
  * - prob2 is calculated by get_mon_num_prep(), which decides whether a
  *         monster is appropriate based on a secondary function; prob2 is
  *         always either prob1 or 0.
- * - prob3 is calculated by get_mon_num(), which checks whether universal
- *         restrictions apply (for example, unique monsters can only appear
- *         once on a given level); prob3 is always either prob2 or 0.
+ * - prob3 is unused; get_mon_num() checks whether universal restrictions
+ *         apply (for example, unique monsters can only appear once on a
+ *         given level) to the races it draws.
+ *
+ * Races are drawn from alias tables, built as needed for each allocation
+ * level from either prob1 or, while get_mon_num_prep() has a restriction in
+ * place, prob2.  The prob1 tables are kept; the prob2 ones are thrown away
+ * when the restriction changes.
  * ------------------------------------------------------------------------ */
 static int16_t alloc_race_size;
 static struct alloc_entry *alloc_race_table;
 
+/**
+ * The races which may be drawn for an allocation level
+ */
+struct race_alias {
+	bool built;
+	struct rand_alias *table;	/* NULL if no race may be drawn */
+	int *entry;			/* Allocation table entry of each choice */
+	uint32_t *weight;		/* Probability of each choice */
+};
+
+static int alloc_race_max_level;
+static struct race_alias *race_alias_base;
+static struct race_alias *race_alias_hook;
+static bool race_alias_hooked;
+
+/**
+ * Most draws that break universal restrictions are simply redrawn; after this
+ * many in a row the allowed races are picked from directly
+ */
+#define RACE_ALIAS_TRIES 16
+
 /**
  * Initialize monster allocation info
  */
@@ -134,9 +161,34 @@ static void init_race_allocs(void) {
 	}
 	mem_free(already_counted);
 	mem_free(num);
+
+	/* Prepare for the alias tables */
+	alloc_race_max_level = table[alloc_race_size - 1].level;
+	race_alias_base = mem_zalloc((alloc_race_max_level + 1)
+		* sizeof(*race_alias_base));
+	race_alias_hook = mem_zalloc((alloc_race_max_level + 1)
+		* sizeof(*race_alias_hook));
+	race_alias_hooked = false;
+}
+
+static void free_race_alias(struct race_alias *ra)
+{
+	if (!ra->built) return;
+	Rand_alias_free(ra->table);
+	mem_free(ra->entry);
+	mem_free(ra->weight);
+	memset(ra, 0, sizeof(*ra));
 }
 
 static void cleanup_race_allocs(void) {
+	int i;
+
+	for (i = 0; i <= alloc_race_max_level; i++) {
+		free_race_alias(&race_alias_base[i]);
+		free_race_alias(&race_alias_hook[i]);
+	}
+	mem_free(race_alias_hook);
+	mem_free(race_alias_base);
 	mem_free(alloc_race_table);
 }
 
@@ -165,31 +217,126 @@ void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race))
 			entry->prob2 = 0;
 		}
 	}
+
+	/* Forget the tables for any previous restriction */
+	for (i = 0; i <= alloc_race_max_level; i++) {
+		free_race_alias(&race_alias_hook[i]);
+	}
+	race_alias_hooked = get_mon_num_hook != NULL;
 }
 
 /**
- * Helper function for get_mon_num(). Scans the prepared monster allocation
- * table and picks a random monster. Returns the index of a monster in
- * `table`.
+ * Get the alias table for races of the given level or shallower, building it
+ * if need be.
  */
-static struct monster_race *get_mon_race_aux(long total,
-											 const alloc_entry *table)
+static const struct race_alias *get_race_alias(int level)
 {
-	int i;
+	struct race_alias *ra;
+	int i, n = 0;
 
-	/* Pick a monster */
-	long value = randint0(total);
+	level = MIN(MAX(level, 0), alloc_race_max_level);
+	ra = race_alias_hooked ? &race_alias_hook[level] : &race_alias_base[level];
+	if (ra->built) return ra;
 
-	/* Find the monster */
+	ra->entry = mem_zalloc(alloc_race_size * sizeof(*ra->entry));
+	ra->weight = mem_zalloc(alloc_race_size * sizeof(*ra->weight));
 	for (i = 0; i < alloc_race_size; i++) {
-		/* Found the entry */
-		if (value < table[i].prob3) break;
+		const alloc_entry *entry = &alloc_race_table[i];
+		int p = race_alias_hooked ? entry->prob2 : entry->prob1;
+
+		/* Monsters are sorted by depth */
+		if (entry->level > level) break;
+
+		/* No town monsters in dungeon */
+		if (level > 0 && entry->level <= 0) continue;
+
+		if (p <= 0) continue;
+		ra->entry[n] = i;
+		ra->weight[n] = p;
+		n++;
+	}
+	ra->table = Rand_alias_new(ra->weight, n);
+	ra->built = true;
+
+	return ra;
+}
+
+/**
+ * Check whether seasonal monsters may appear.  The date is only looked up
+ * once a game turn, so once for all the monsters on a new level.
+ */
+static bool seasonal_monsters_allowed(void)
+{
+	static bool checked = false;
+	static int32_t checked_turn;
+	static bool allowed;
+
+	if (!checked || checked_turn != turn) {
+		time_t cur_time = time(NULL);
+		struct tm *date = localtime(&cur_time);
+
+		allowed = date->tm_mon == 11 && date->tm_mday >= 24
+			&& date->tm_mday <= 26;
+		checked = true;
+		checked_turn = turn;
+	}
+	return allowed;
+}
+
+/**
+ * Check the universal restrictions on a race appearing.
+ */
+static bool mon_race_allowed(const struct monster_race *race,
+		int current_level)
+{
+	/* No seasonal monsters outside of Christmas */
+	if (rf_has(race->flags, RF_SEASONAL) && !seasonal_monsters_allowed())
+		return false;
 
-		/* Decrement */
-		value -= table[i].prob3;
+	/* Only one copy of a unique must be around at the same time */
+	if (rf_has(race->flags, RF_UNIQUE) && (race->cur_num >= race->max_num))
+		return false;
+
+	/* Some monsters never appear out of depth */
+	if (rf_has(race->flags, RF_FORCE_DEPTH) && race->level > current_level)
+		return false;
+
+	return true;
+}
+
+/**
+ * Helper function for get_mon_num().  Picks a random race from an alias
+ * table, among those which pass the universal restrictions; returns NULL if
+ * there are none.
+ */
+static struct monster_race *get_mon_race_aux(const struct race_alias *ra,
+		int current_level)
+{
+	struct monster_race *race = NULL;
+	long total = 0, value;
+	int i;
+
+	/* Draw until an allowed race comes up */
+	for (i = 0; i < RACE_ALIAS_TRIES; i++) {
+		race = &r_info[alloc_race_table[ra->entry[Rand_alias(ra->table)]].index];
+		if (mon_race_allowed(race, current_level)) return race;
+	}
+
+	/* Too many disallowed, so total the allowed races and pick from them */
+	for (i = 0; i < ra->table->count; i++) {
+		race = &r_info[alloc_race_table[ra->entry[i]].index];
+		if (mon_race_allowed(race, current_level)) total += ra->weight[i];
+	}
+	if (total <= 0) return NULL;
+	value = randint0(total);
+	for (i = 0; i < ra->table->count; i++) {
+		race = &r_info[alloc_race_table[ra->entry[i]].index];
+		if (!mon_race_allowed(race, current_level)) continue;
+		if (value < (long) ra->weight[i]) break;
+		value -= ra->weight[i];
 	}
 
-	return &r_info[table[i].index];
+	return race;
 }
 
 /**
@@ -199,10 +346,9 @@ static struct monster_race *get_mon_race_aux(long total,
  * \param current_level is the level where the monster will be placed - used
  * for checks on an out-of-depth monster.
  *
- * This function uses the "prob2" field of the monster allocation table,
- * and various local information, to calculate the "prob3" field of the
- * same table, which is then used to choose an appropriate monster, in
- * a relatively efficient manner.
+ * This function draws from the alias table for the level (see
+ * get_race_alias()), redrawing races that fail the universal restrictions,
+ * so each draw takes constant time in the usual case.
  *
  * Note that town monsters will *only* be created in the town, and
  * "normal" monsters will *never* be created in the town, unless the
@@ -220,59 +366,22 @@ static struct monster_race *get_mon_race_aux(long total,
  */
 struct monster_race *get_mon_num(int generated_level, int current_level)
 {
-	int i, p;
-	long total;
+	int p;
 	struct monster_race *race;
-	alloc_entry *table = alloc_race_table;
-	time_t cur_time = time(NULL);
-	struct tm *date = localtime(&cur_time);
+	const struct race_alias *ra;
 
 	/* Occasionally produce a nastier monster in the dungeon */
 	if (generated_level > 0 && one_in_(z_info->ood_monster_chance))
 		generated_level += MIN(generated_level / 4 + 2,
 			z_info->ood_monster_amount);
 
-	total = 0L;
-
-	/* Process probabilities */
-	for (i = 0; i < alloc_race_size; i++) {
-		/* Monsters are sorted by depth */
-		if (table[i].level > generated_level) break;
-
-		/* Default */
-		table[i].prob3 = 0;
-
-		/* No town monsters in dungeon */
-		if (generated_level > 0 && table[i].level <= 0) continue;
-
-		/* Get the chosen monster */
-		race = &r_info[table[i].index];
-
-		/* No seasonal monsters outside of Christmas */
-		if (rf_has(race->flags, RF_SEASONAL) &&
-			!(date->tm_mon == 11 && date->tm_mday >= 24 && date->tm_mday <= 26))
-			continue;
-
-		/* Only one copy of a unique must be around at the same time */
-		if (rf_has(race->flags, RF_UNIQUE) && (race->cur_num >= race->max_num))
-			continue;
-
-		/* Some monsters never appear out of depth */
-		if (rf_has(race->flags, RF_FORCE_DEPTH) && race->level > current_level)
-			continue;
-
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
-
-		/* Total */
-		total += table[i].prob3;
-	}
-
 	/* No legal monsters */
-	if (total <= 0) return NULL;
+	ra = get_race_alias(generated_level);
+	if (!ra->table) return NULL;
 
 	/* Pick a monster */
-	race = get_mon_race_aux(total, table);
+	race = get_mon_race_aux(ra, current_level);
+	if (!race) return NULL;
 
 	/* Try for a "harder" monster once (50%) or twice (10%) */
 	p = randint0(100);
@@ -281,7 +390,7 @@ struct monster_race *get_mon_num(int generated_level, int current_level)
 		struct monster_race *old = race;
 
 		/* Pick a new monster */
-		race = get_mon_race_aux(total, table);
+		race = get_mon_race_aux(ra, current_level);
 
 		/* Keep the deepest one */
 		if (race->level < old->level) race = old;
@@ -292,7 +401,7 @@ struct monster_race *get_mon_num(int generated_level, int current_level)
 		struct monster_race *old = race;
 
 		/* Pick a monster */
-		race = get_mon_race_aux(total, table);
+		race = get_mon_race_aux(ra, current_level);
 
 		/* Keep the deepest one */
 		if (race->level < old->level) race = old;
@@ -346,9 +455,10 @@ void delete_monster_idx(struct chunk *c, int m_idx)
 		(void) player_clear_timed(player, TMD_COMMAND, true, true);
 	}
 
-	/* Monster is gone from square and group */
+	/* Monster is gone from square, group and schedule */
 	square_set_mon(c, grid, 0);
 	monster_remove_from_groups(c, mon);
+	unschedule_monster(c, mon);
 
 	/* Delete objects */
 	struct object *obj = mon->held_obj;
@@ -462,6 +572,9 @@ void monster_index_move(struct chunk *c, int i1, int i2)
 
 	/* Wipe hole */
 	memset(cave_monster(c, i1), 0, sizeof(struct monster));
+
+	/* Update the schedule */
+	move_monster_schedule(c, i1, i2);
 }
 
 
@@ -563,6 +676,9 @@ void wipe_mon_list(struct chunk *c, struct player *p)
 {
 	int m_idx, i;
 
+	/* Nothing left to schedule */
+	unschedule_monsters(c);
+
 	/* Delete all the monsters */
 	for (m_idx = cave_monster_max(c) - 1; m_idx >= 1; m_idx--) {
 		struct monster *mon = cave_monster(c, m_idx);
@@ -1034,6 +1150,9 @@ int16_t place_monster(struct chunk *c, struct loc grid, struct monster *mon,
 
 	update_mon(new_mon, c, true);
 
+	/* Work out when it can move */
+	schedule_monster(c, new_mon);
+
 	/* Count the number of "reproducers" */
 	if (rf_has(new_mon->race->flags, RF_MULTIPLY)) c->num_repro++;
 
@@ -24,6 +24,7 @@
 
 #include "angband.h"
 #include "cave.h"
+#include "game-profile.h"
 #include "game-world.h"
 #include "init.h"
 #include "monster.h"
@@ -115,10 +116,10 @@ static bool monster_can_hear(struct monster *mon)
  */
 static bool monster_can_smell(struct monster *mon)
 {
-	if (cave->scent.grids[mon->grid.y][mon->grid.x] == 0) {
+	if (square_scent(cave, mon->grid) == 0) {
 		return false;
 	}
-	return mon->race->smell > cave->scent.grids[mon->grid.y][mon->grid.x];
+	return mon->race->smell > square_scent(cave, mon->grid);
 }
 
 /**
@@ -372,7 +373,7 @@ static bool get_move_bodyguard(struct monster *mon)
  *
  * Ghosts and rock-eaters generally just head straight for the player. Other
  * monsters try sight, then current sound as saved in cave->noise.grids[y][x],
- * then current scent as saved in cave->scent.grids[y][x].
+ * then current scent as saved in square_scent(cave, loc(x, y)).
  *
  * This function assumes the monster is moving to an adjacent grid, and so the
  * noise can be louder by at most 1.  The monster target grid set by sound or
@@ -474,9 +475,9 @@ static bool get_move_advance(struct monster *mon, bool *track)
 
 			/* If no good sound yet, use scent */
 			smelled_scent = mon->race->smell
-				- cave->scent.grids[grid.y][grid.x];
+				- square_scent(cave, grid);
 			if ((smelled_scent > best_scent) &&
-				(cave->scent.grids[grid.y][grid.x] != 0)) {
+				(square_scent(cave, grid) != 0)) {
 				best_scent = smelled_scent;
 				best_grid = grid;
 				found = true;
@@ -1755,7 +1756,7 @@ static void monster_reduce_sleep(struct monster *mon)
 
 		/* Test - wake up faster in hearing distance of the player 
 		 * Note no dependence on stealth for now */
-		if ((local_noise > 0) && (local_noise < 50)) {
+		if ((local_noise > 0) && (local_noise < MON_WAKE_NOISE)) {
 			sleep_reduction = (100 / local_noise);
 		}
 
@@ -1867,10 +1868,338 @@ static void regen_monster(struct monster *mon, int num)
 }
 
 
+/**
+ * ------------------------------------------------------------------------
+ * Monster turn scheduling
+ * ------------------------------------------------------------------------ */
+/**
+ * On most game turns most monsters only gain energy, so rather than visit
+ * every monster on every turn, the monsters on the current level are kept in
+ * buckets by the game turn on which they will next have enough energy to
+ * move.  The energy a monster gains in between is credited when it is
+ * needed: when the monster is due to move, just before anything changes its
+ * speed or energy, and when the level is saved or left.  Every monster is
+ * still visited on the turns when monsters regenerate.
+ *
+ * A monster is credited for the current turn only if process_monsters()
+ * would already have visited it, so monster energy, and with it the order in
+ * which monsters act, is exactly as if every monster were visited every turn.
+ */
+
+/**
+ * The energy a monster gains in a game turn at its current speed
+ */
+static int monster_turn_energy(const struct monster *mon)
+{
+	int mspeed = mon->mspeed;
+
+	if (mon->m_timed[MON_TMD_FAST])
+		mspeed += 10;
+	if (mon->m_timed[MON_TMD_SLOW]) {
+		int slow_level = monster_effect_level(mon, MON_TMD_SLOW);
+		mspeed -= (2 * slow_level);
+	}
+
+	return turn_energy(mspeed);
+}
+
+/**
+ * The first game turn whose energy a monster would not yet have been given
+ * if every monster were visited every turn
+ */
+static int32_t credit_target(const struct monster_schedule *s,
+		const struct monster *mon)
+{
+	if (mflag_has(mon->mflag, MFLAG_HANDLED)) return turn + 1;
+	if (s->scan_turn == turn && mon->midx > s->scan_index) return turn + 1;
+	return turn;
+}
+
+/**
+ * Remove a monster from its bucket
+ */
+static void unfile_monster(struct monster_schedule *s, int m_idx)
+{
+	int next = s->next[m_idx], prev = s->prev[m_idx];
+
+	if (s->bucket[m_idx] < 0) return;
+	if (prev) {
+		s->next[prev] = next;
+	} else {
+		s->head[s->bucket[m_idx]] = next;
+	}
+	if (next) s->prev[next] = prev;
+	s->bucket[m_idx] = -1;
+	s->next[m_idx] = 0;
+	s->prev[m_idx] = 0;
+}
+
+/**
+ * Put a monster in the bucket for the turn on which it can next move, or the
+ * furthest bucket if that is too far ahead
+ */
+static void file_monster(struct monster_schedule *s, struct monster *mon)
+{
+	int m_idx = mon->midx;
+	int32_t wake = s->credited[m_idx];
+	int b;
+
+	if (mon->energy < z_info->move_energy) {
+		int gain = monster_turn_energy(mon);
+		int need = z_info->move_energy - mon->energy;
+
+		wake += (gain > 0) ? (need + gain - 1) / gain : MON_SCHEDULE_BUCKETS;
+	}
+	s->wake[m_idx] = wake;
+
+	if (wake - turn >= MON_SCHEDULE_BUCKETS) {
+		wake = turn + MON_SCHEDULE_BUCKETS - 1;
+	} else if (wake < turn) {
+		wake = turn;
+	}
+	b = wake % MON_SCHEDULE_BUCKETS;
+	s->bucket[m_idx] = b;
+	s->prev[m_idx] = 0;
+	s->next[m_idx] = s->head[b];
+	if (s->head[b]) s->prev[s->head[b]] = m_idx;
+	s->head[b] = m_idx;
+}
+
+/**
+ * Note that a monster has been marked as handled, so reset_monsters() can
+ * find it
+ */
+static void note_handled(struct monster_schedule *s, int m_idx)
+{
+	if (s->handled_count < 0) return;
+	if (s->handled_count == z_info->level_monster_max) {
+		s->handled_count = -1;
+		return;
+	}
+	s->handled[s->handled_count++] = m_idx;
+}
+
+/**
+ * Start scheduling the monsters on a level
+ */
+void schedule_monsters(struct chunk *c)
+{
+	struct monster_schedule *s;
+	int i;
+
+	if (c->schedule) unschedule_monsters(c);
+
+	s = mem_zalloc(sizeof(*s));
+	s->credited = mem_zalloc(z_info->level_monster_max * sizeof(*s->credited));
+	s->wake = mem_zalloc(z_info->level_monster_max * sizeof(*s->wake));
+	s->bucket = mem_alloc(z_info->level_monster_max * sizeof(*s->bucket));
+	s->next = mem_zalloc(z_info->level_monster_max * sizeof(*s->next));
+	s->prev = mem_zalloc(z_info->level_monster_max * sizeof(*s->prev));
+	s->due = mem_zalloc(z_info->level_monster_max * sizeof(*s->due));
+	s->handled = mem_zalloc(z_info->level_monster_max * sizeof(*s->handled));
+	for (i = 0; i < z_info->level_monster_max; i++) {
+		s->bucket[i] = -1;
+	}
+	s->scan_turn = turn - 1;
+	c->schedule = s;
+
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+
+		if (!mon->race) continue;
+		if (mflag_has(mon->mflag, MFLAG_HANDLED)) note_handled(s, i);
+		schedule_monster(c, mon);
+	}
+}
+
+/**
+ * Stop scheduling the monsters on a level, giving them all the energy they
+ * are owed
+ */
+void unschedule_monsters(struct chunk *c)
+{
+	int i;
+
+	if (!c->schedule) return;
+	for (i = 1; i < cave_monster_max(c); i++) {
+		sync_monster_energy(c, cave_monster(c, i));
+	}
+	free_monster_schedule(c);
+}
+
+/**
+ * Free a level's monster schedule, without giving monsters their energy
+ */
+void free_monster_schedule(struct chunk *c)
+{
+	struct monster_schedule *s = c->schedule;
+
+	if (!s) return;
+	c->schedule = NULL;
+	mem_free(s->credited);
+	mem_free(s->wake);
+	mem_free(s->bucket);
+	mem_free(s->next);
+	mem_free(s->prev);
+	mem_free(s->due);
+	mem_free(s->handled);
+	mem_free(s);
+}
+
+/**
+ * Give a monster the energy it is owed; this must be done before anything
+ * changes its speed or energy
+ */
+void sync_monster_energy(struct chunk *c, struct monster *mon)
+{
+	struct monster_schedule *s = c->schedule;
+	int32_t target;
+
+	if (!s || !mon->race || s->bucket[mon->midx] < 0) return;
+	target = credit_target(s, mon);
+	if (s->credited[mon->midx] < target) {
+		mon->energy += (target - s->credited[mon->midx])
+			* monster_turn_energy(mon);
+		s->credited[mon->midx] = target;
+	}
+}
+
+/**
+ * Work out when a monster can next move; this must be done after anything
+ * changes its speed or energy, and when it is placed
+ */
+void schedule_monster(struct chunk *c, struct monster *mon)
+{
+	struct monster_schedule *s = c->schedule;
+
+	if (!s || !mon->race) return;
+	if (s->bucket[mon->midx] < 0) {
+		s->credited[mon->midx] = credit_target(s, mon);
+	} else {
+		unfile_monster(s, mon->midx);
+	}
+	file_monster(s, mon);
+}
+
+/**
+ * Stop scheduling a monster which is being removed
+ */
+void unschedule_monster(struct chunk *c, struct monster *mon)
+{
+	if (!c->schedule) return;
+	unfile_monster(c->schedule, mon->midx);
+}
+
+/**
+ * Carry a monster's schedule over to its new index
+ */
+void move_monster_schedule(struct chunk *c, int i1, int i2)
+{
+	struct monster_schedule *s = c->schedule;
+	struct monster *mon = cave_monster(c, i2);
+
+	if (!s || s->bucket[i1] < 0) return;
+	unfile_monster(s, i1);
+	s->credited[i2] = s->credited[i1];
+	if (mflag_has(mon->mflag, MFLAG_HANDLED)) note_handled(s, i2);
+	file_monster(s, mon);
+}
+
+/**
+ * Order monster indices from highest to lowest
+ */
+static int cmp_midx_descending(const void *a, const void *b)
+{
+	return *(const int *) b - *(const int *) a;
+}
+
+/**
+ * Find the monsters due to move this turn, highest index first, and return
+ * how many there are
+ */
+static int find_due_monsters(struct monster_schedule *s)
+{
+	int b = turn % MON_SCHEDULE_BUCKETS;
+	int i = s->head[b], n = 0;
+
+	while (i) {
+		int next = s->next[i];
+
+		if (s->wake[i] <= turn) {
+			s->due[n++] = i;
+		} else {
+			/* Filed in the furthest bucket, so move it along */
+			unfile_monster(s, i);
+			file_monster(s, cave_monster(cave, i));
+		}
+		i = next;
+	}
+	sort(s->due, n, sizeof(*s->due), cmp_midx_descending);
+
+	return n;
+}
+
+
 /**
  * ------------------------------------------------------------------------
  * Monster processing routines to be called by the main game loop
  * ------------------------------------------------------------------------ */
+/**
+ * Give a monster its energy for this game turn, and let it act if it had
+ * enough energy to move
+ */
+static void process_monster(struct monster *mon, bool regen)
+{
+	struct monster_schedule *s = cave->schedule;
+
+	/* Does this monster have enough energy to move? */
+	bool moving = mon->energy >= z_info->move_energy ? true : false;
+
+	/* Prevent reprocessing */
+	mflag_on(mon->mflag, MFLAG_HANDLED);
+	if (s) note_handled(s, mon->midx);
+
+	/* Handle monster regeneration if requested */
+	if (regen)
+		regen_monster(mon, 1);
+
+	/* Give this monster some energy */
+	mon->energy += monster_turn_energy(mon);
+	if (s) s->credited[mon->midx] = turn + 1;
+
+	/* End the turn of monsters without enough energy to move */
+	if (!moving)
+		return;
+
+	/* Use up "some" energy */
+	mon->energy -= z_info->move_energy;
+
+	/* Mimics lie in wait */
+	if (monster_is_mimicking(mon)) return;
+
+	/* Check if the monster is active */
+	if (monster_check_active(mon)) {
+		/* Process timed effects - skip turn if necessary */
+		if (process_monster_timed(mon))
+			return;
+
+		/* Set this monster to be the current actor */
+		cave->mon_current = mon->midx;
+
+		/* The monster takes its turn */
+		monster_turn(mon);
+
+		/*
+		 * For symmetry with the player, monster can take
+		 * terrain damage after its turn.
+		 */
+		monster_take_terrain_damage(mon);
+
+		/* Monster is no longer current */
+		cave->mon_current = -1;
+	}
+}
+
 /**
  * Process all the "live" monsters, once per game turn.
  *
@@ -1878,29 +2207,50 @@ static void regen_monster(struct monster *mon, int num)
  * (backwards, so we can excise any "freshly dead" monsters), energizing each
  * monster, and allowing fully energized monsters to move, attack, pass, etc.
  *
+ * When the level's monsters are scheduled, only the monsters due to move are
+ * visited, in the same order, except on turns when monsters regenerate; see
+ * schedule_monsters().
+ *
  * This function and its children are responsible for a considerable fraction
  * of the processor time in normal situations, greater if the character is
  * resting.
  */
 void process_monsters(int minimum_energy)
 {
-	int i;
-	int mspeed;
+	struct monster_schedule *s = cave->schedule;
+	int top = cave_monster_max(cave) - 1;
+	int j, count;
+	bool full, left = false;
 
 	/* Only process some things every so often */
 	bool regen = false;
 
+	profile_enter(PROFILE_MONSTERS);
+
 	/* Regenerate hitpoints and mana every 100 game turns */
 	if (turn % 100 == 0)
 		regen = true;
 
+	/* Visit only the monsters due to move, except when regenerating */
+	full = !s || (regen && !minimum_energy);
+	count = full ? top : find_due_monsters(s);
+
+	/* Note how far through the monsters this turn's visits have got */
+	if (s && !minimum_energy) {
+		s->scan_turn = turn;
+		s->scan_index = z_info->level_monster_max;
+	}
+
 	/* Process the monsters (backwards) */
-	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
+	for (j = 0; j < count; j++) {
+		int i = full ? top - j : s->due[j];
 		struct monster *mon;
-		bool moving;
 
 		/* Handle "leaving" */
-		if (player->is_dead || player->upkeep->generate_level) break;
+		if (player->is_dead || player->upkeep->generate_level) {
+			left = true;
+			break;
+		}
 
 		/* Get a 'live' monster */
 		mon = cave_monster(cave, i);
@@ -1910,67 +2260,37 @@ void process_monsters(int minimum_energy)
 		if (mflag_has(mon->mflag, MFLAG_HANDLED))
 			continue;
 
-		/* Not enough energy to move yet */
-		if (mon->energy < minimum_energy) continue;
-
-		/* Does this monster have enough energy to move? */
-		moving = mon->energy >= z_info->move_energy ? true : false;
-
-		/* Prevent reprocessing */
-		mflag_on(mon->mflag, MFLAG_HANDLED);
-
-		/* Handle monster regeneration if requested */
-		if (regen)
-			regen_monster(mon, 1);
-
-		/* Calculate the net speed */
-		mspeed = mon->mspeed;
-		if (mon->m_timed[MON_TMD_FAST])
-			mspeed += 10;
-		if (mon->m_timed[MON_TMD_SLOW]) {
-			int slow_level = monster_effect_level(mon, MON_TMD_SLOW);
-			mspeed -= (2 * slow_level);
+		/* Bring the monster's energy up to date */
+		if (s) {
+			if (!full && s->wake[i] > turn) continue;
+			if (!minimum_energy) s->scan_index = i;
+			sync_monster_energy(cave, mon);
 		}
 
-		/* Give this monster some energy */
-		mon->energy += turn_energy(mspeed);
-
-		/* End the turn of monsters without enough energy to move */
-		if (!moving)
-			continue;
-
-		/* Use up "some" energy */
-		mon->energy -= z_info->move_energy;
-
-		/* Mimics lie in wait */
-		if (monster_is_mimicking(mon)) continue;
-
-		/* Check if the monster is active */
-		if (monster_check_active(mon)) {
-			/* Process timed effects - skip turn if necessary */
-			if (process_monster_timed(mon))
-				continue;
-
-			/* Set this monster to be the current actor */
-			cave->mon_current = i;
-
-			/* The monster takes its turn */
-			monster_turn(mon);
+		/* Not enough energy to move yet */
+		if (mon->energy < minimum_energy) continue;
 
-			/*
-			 * For symmetry with the player, monster can take
-			 * terrain damage after its turn.
-			 */
-			monster_take_terrain_damage(mon);
+		/* Take its turn, and work out when the next one is */
+		process_monster(mon, regen);
+		if (s && mon->race) schedule_monster(cave, mon);
+	}
 
-			/* Monster is no longer current */
-			cave->mon_current = -1;
+	/* Finish this turn's visits */
+	if (s && !minimum_energy) {
+		/* Monsters not reached on leaving the level miss this turn */
+		if (left) {
+			for (j = 1; j < cave_monster_max(cave); j++) {
+				sync_monster_energy(cave, cave_monster(cave, j));
+				if (s->credited[j] <= turn) s->credited[j] = turn + 1;
+			}
 		}
+		s->scan_index = 0;
 	}
 
 	/* Update monster visibility after this */
 	/* XXX This may not be necessary */
 	player->upkeep->update |= PU_MONSTERS;
+	profile_leave(PROFILE_MONSTERS);
 }
 
 /**
@@ -1980,9 +2300,20 @@ void process_monsters(int minimum_energy)
  */
 void reset_monsters(void)
 {
+	struct monster_schedule *s = cave->schedule;
 	int i;
 	struct monster *mon;
 
+	/* Only monsters noted as handled need clearing, if we can */
+	if (s && s->handled_count >= 0) {
+		for (i = 0; i < s->handled_count; i++) {
+			mon = cave_monster(cave, s->handled[i]);
+			mflag_off(mon->mflag, MFLAG_HANDLED);
+		}
+		s->handled_count = 0;
+		return;
+	}
+
 	/* Process the monsters (backwards) */
 	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
 		/* Access the monster */
@@ -1991,6 +2322,7 @@ void reset_monsters(void)
 		/* Monster is ready to go again */
 		mflag_off(mon->mflag, MFLAG_HANDLED);
 	}
+	if (s) s->handled_count = 0;
 }
 
 /**
@@ -18,6 +18,11 @@
 #ifndef MONSTER_MOVE_H
 #define MONSTER_MOVE_H
 
+/**
+ * Sleeping monsters closer to the player than this (as measured by the noise
+ * field) are disturbed more quickly
+ */
+#define MON_WAKE_NOISE 50
 
 enum monster_stagger {
 	 NO_STAGGER = 0,
@@ -26,6 +31,13 @@ enum monster_stagger {
 };
 
 bool multiply_monster(const struct monster *mon);
+void schedule_monsters(struct chunk *c);
+void unschedule_monsters(struct chunk *c);
+void free_monster_schedule(struct chunk *c);
+void sync_monster_energy(struct chunk *c, struct monster *mon);
+void schedule_monster(struct chunk *c, struct monster *mon);
+void unschedule_monster(struct chunk *c, struct monster *mon);
+void move_monster_schedule(struct chunk *c, int i1, int i2);
 void process_monsters(int minimum_energy);
 void reset_monsters(void);
 void restore_monsters(void);
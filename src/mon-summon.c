@@ -23,6 +23,7 @@
 #include "init.h"
 #include "mon-group.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-summon.h"
 #include "mon-util.h"
 #include "parser.h"
@@ -372,7 +373,9 @@ static int call_monster(struct loc grid)
 	monster_wake(mon, false, 100);
 
 	/* Set it's energy to 0 */
+	sync_monster_energy(cave, mon);
 	mon->energy = 0;
+	schedule_monster(cave, mon);
 
 	return (mon->race->level);
 }
@@ -472,7 +475,9 @@ int summon_specific(struct loc grid, int lev, int type, bool delay, bool call)
 			 + m_e_per_turn * p_e_per_turn - 1)
 			 / (m_e_per_turn * p_e_per_turn);
 
+		sync_monster_energy(cave, mon);
 		mon->energy = 0;
+		schedule_monster(cave, mon);
 		if (turns > 0) {
 			/* Set timer directly to avoid resistance */
 			mon->m_timed[MON_TMD_HOLD] = MIN(turns, 32767);
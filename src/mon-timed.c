@@ -19,6 +19,7 @@
 #include "angband.h"
 #include "mon-desc.h"
 #include "mon-lore.h"
+#include "mon-move.h"
 #include "mon-msg.h"
 #include "mon-predicate.h"
 #include "mon-spell.h"
@@ -187,6 +188,12 @@ static bool mon_set_timed(struct monster *mon,
 	if (check_resist && does_resist(mon, effect_type, timer, flag)) {
 		resisted = true;
 		m_note = MON_MSG_UNAFFECTED;
+	} else if (effect_type == MON_TMD_FAST || effect_type == MON_TMD_SLOW) {
+		/* Speed changes affect when the monster can next move */
+		sync_monster_energy(cave, mon);
+		mon->m_timed[effect_type] = timer;
+		schedule_monster(cave, mon);
+		update = true;
 	} else {
 		mon->m_timed[effect_type] = timer;
 		update = true;
@@ -25,6 +25,7 @@
 #include "mon-list.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-msg.h"
 #include "mon-predicate.h"
 #include "mon-spell.h"
@@ -119,25 +120,22 @@ void create_mon_flag_mask(bitflag *f, ...)
 struct monster_race *lookup_monster(const char *name)
 {
 	int i;
-	struct monster_race *closest = NULL;
 
-	/* Look for it */
+	/* Look for it; data files almost always give the exact name */
 	for (i = 0; i < z_info->r_max; i++) {
 		struct monster_race *race = &r_info[i];
-		if (!race->name)
-			continue;
-
-		/* Test for equality */
-		if (my_stricmp(name, race->name) == 0)
+		if (race->name && my_stricmp(name, race->name) == 0)
 			return race;
+	}
 
-		/* Test for close matches */
-		if (!closest && my_stristr(race->name, name))
-			closest = race;
+	/* Settle for the first close match */
+	for (i = 0; i < z_info->r_max; i++) {
+		struct monster_race *race = &r_info[i];
+		if (race->name && my_stristr(race->name, name))
+			return race;
 	}
 
-	/* Return our best match */
-	return closest;
+	return NULL;
 }
 
 /**
@@ -1659,8 +1657,10 @@ bool monster_change_shape(struct monster *mon)
 	/* Set the race */
 	if (race) {
 		if (!mon->original_race) mon->original_race = mon->race;
+		sync_monster_energy(cave, mon);
 		mon->race = race;
 		mon->mspeed += mon->race->speed - mon->original_race->speed;
+		schedule_monster(cave, mon);
 	}
 
 	/* Emergency teleport if needed */
@@ -1689,9 +1689,11 @@ bool monster_revert_shape(struct monster *mon)
 			player->upkeep->redraw |= (PR_MONLIST);
 			square_light_spot(cave, mon->grid);
 		}
+		sync_monster_energy(cave, mon);
 		mon->mspeed += mon->original_race->speed - mon->race->speed;
 		mon->race = mon->original_race;
 		mon->original_race = NULL;
+		schedule_monster(cave, mon);
 
 		/* Emergency teleport if needed */
 		if (!monster_passes_walls(mon) &&
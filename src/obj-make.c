@@ -33,33 +33,32 @@
 #include "obj-util.h"
 
 /**
- * Stores cumulative probability distribution for objects at each level.  The
- * value at ilv * (z_info->k_max + 1) + itm is the probablity, out of
- * obj_alloc[ilv * (z_info->k_max + 1) + z_info->k_max], that an item whose
- * index is less than itm occurs at level, ilv.
+ * The kinds which may be drawn for one combination of level, whether only
+ * good kinds are wanted, and tval (zero for any tval).  These are built as
+ * they are first needed.
  */
-static uint32_t *obj_alloc;
+struct kind_alias {
+	bool built;
+	struct rand_alias *table;	/* NULL if no kind may be drawn */
+	int *kidx;			/* Kind index of each choice */
+};
 
 /**
- * Has the same layout and interpretation as obj_alloc, but only items that
- * are good or better contribute to the cumulative probability distribution.
+ * Alias tables for drawing object kinds; the table for level, ilv, good
+ * flag, g, and tval, tv, is at (ilv * 2 + g) * TV_MAX + tv.
  */
-static uint32_t *obj_alloc_great;
+static struct kind_alias *obj_alias;
 
-/**
- * Store the total allocation value for each tval by level.  The value at
- * ilv * TV_MAX + tval is the total for tval at the level, ilv.
- */
-static uint32_t *obj_total_tval;
+static int16_t alloc_ego_size = 0;
+static alloc_entry *alloc_ego_table;
 
 /**
- * Same layout and interpretation as obj_total_tval, but only items that are
- * good or better contribute.
+ * The entries in alloc_ego_table which may apply to each object kind.  Those
+ * for the kind with index, kidx, are ego_kind_list[ego_kind_start[kidx]] up
+ * to but not including ego_kind_list[ego_kind_start[kidx + 1]].
  */
-static uint32_t *obj_total_tval_great;
-
-static int16_t alloc_ego_size = 0;
-static alloc_entry *alloc_ego_table;
+static int *ego_kind_start;
+static int *ego_kind_list;
 
 struct money {
 	char *name;
@@ -73,48 +72,31 @@ static int num_money_types;
  * Initialize object allocation info
  */
 static void alloc_init_objects(void) {
-	int item, lev;
-	int k_max = z_info->k_max;
-
-	/* Allocate */
-	obj_alloc = mem_alloc_alt((z_info->max_obj_depth + 1) * (k_max + 1) * sizeof(*obj_alloc));
-	obj_alloc_great = mem_alloc_alt((z_info->max_obj_depth + 1) * (k_max + 1) * sizeof(*obj_alloc_great));
-	obj_total_tval = mem_zalloc_alt((z_info->max_obj_depth + 1) * TV_MAX * sizeof(*obj_total_tval));
-	obj_total_tval_great = mem_zalloc_alt((z_info->max_obj_depth + 1) * TV_MAX * sizeof(*obj_total_tval));
-
-	/* The cumulative chance starts at zero for each level. */
-	for (lev = 0; lev <= z_info->max_obj_depth; lev++) {
-		obj_alloc[lev * (k_max + 1)] = 0;
-		obj_alloc_great[lev * (k_max + 1)] = 0;
-	}
-
-	/* Fill the cumulative probability tables */
-	for (item = 0; item < k_max; item++) {
-		const struct object_kind *kind = &k_info[item];
-
-		int min = kind->alloc_min;
-		int max = kind->alloc_max;
-
-		/* Go through all the dungeon levels */
-		for (lev = 0; lev <= z_info->max_obj_depth; lev++) {
-			int rarity = kind->alloc_prob;
-
-			/* Add to the cumulative prob. in the standard table */
-			if ((lev < min) || (lev > max)) rarity = 0;
-			assert(rarity >= 0 && obj_alloc[(lev * (k_max + 1)) + item] <= (uint32_t)-1 - rarity);
-			obj_alloc[(lev * (k_max + 1)) + item + 1] =
-				obj_alloc[(lev * (k_max + 1)) + item] + rarity;
+	obj_alias = mem_zalloc_alt((z_info->max_obj_depth + 1) * 2 * TV_MAX
+		* sizeof(*obj_alias));
+}
 
-			obj_total_tval[lev * TV_MAX + kind->tval] += rarity;
+static void free_kind_alias(struct kind_alias *ka)
+{
+	if (!ka->built) return;
+	Rand_alias_free(ka->table);
+	mem_free(ka->kidx);
+	memset(ka, 0, sizeof(*ka));
+}
 
-			/* Add to the cumulative prob. in the "great" table */
-			if (!kind_is_good(kind)) rarity = 0;
-			obj_alloc_great[(lev * (k_max + 1)) + item + 1] =
-				obj_alloc_great[(lev * (k_max + 1)) + item] + rarity;
+/**
+ * Check that an ego's possible item is not a repeat of an earlier one for
+ * the same kind.
+ */
+static bool ego_poss_first(const struct ego_item *ego,
+		const struct poss_item *poss)
+{
+	const struct poss_item *prev;
 
-			obj_total_tval_great[lev * TV_MAX + kind->tval] += rarity;
-		}
+	for (prev = ego->poss_items; prev != poss; prev = prev->next) {
+		if (prev->kidx == poss->kidx) return false;
 	}
+	return true;
 }
 
 /*
@@ -127,6 +109,7 @@ static void alloc_init_objects(void) {
 static void alloc_init_egos(void) {
 	int *num = mem_zalloc((z_info->max_obj_depth + 1) * sizeof(int));
 	int *level_total = mem_zalloc((z_info->max_obj_depth + 1) * sizeof(int));
+	int *filled;
 
 	int i;
 
@@ -177,6 +160,34 @@ static void alloc_init_egos(void) {
 
 	mem_free(level_total);
 	mem_free(num);
+
+	/* List the egos which may apply to each kind, in table order */
+	ego_kind_start = mem_zalloc((z_info->k_max + 1) * sizeof(int));
+	for (i = 0; i < alloc_ego_size; i++) {
+		struct ego_item *ego = &e_info[alloc_ego_table[i].index];
+		struct poss_item *poss;
+
+		for (poss = ego->poss_items; poss; poss = poss->next) {
+			if (!ego_poss_first(ego, poss)) continue;
+			ego_kind_start[poss->kidx + 1]++;
+		}
+	}
+	for (i = 0; i < z_info->k_max; i++)
+		ego_kind_start[i + 1] += ego_kind_start[i];
+	ego_kind_list = mem_zalloc((ego_kind_start[z_info->k_max] + 1)
+		* sizeof(int));
+	filled = mem_zalloc(z_info->k_max * sizeof(int));
+	for (i = 0; i < alloc_ego_size; i++) {
+		struct ego_item *ego = &e_info[alloc_ego_table[i].index];
+		struct poss_item *poss;
+
+		for (poss = ego->poss_items; poss; poss = poss->next) {
+			if (!ego_poss_first(ego, poss)) continue;
+			ego_kind_list[ego_kind_start[poss->kidx]
+				+ filled[poss->kidx]++] = i;
+		}
+	}
+	mem_free(filled);
 }
 
 /*
@@ -215,11 +226,14 @@ static void cleanup_obj_make(void) {
 		string_free(money_type[i].name);
 	}
 	mem_free(money_type);
+	mem_free(ego_kind_list);
+	mem_free(ego_kind_start);
 	mem_free(alloc_ego_table);
-	mem_free_alt(obj_total_tval_great);
-	mem_free_alt(obj_total_tval);
-	mem_free_alt(obj_alloc_great);
-	mem_free_alt(obj_alloc);
+	alloc_ego_size = 0;
+	for (i = 0; i < (z_info->max_obj_depth + 1) * 2 * TV_MAX; i++) {
+		free_kind_alias(&obj_alias[i]);
+	}
+	mem_free_alt(obj_alias);
 }
 
 /*** Make an ego item ***/
@@ -307,76 +321,48 @@ static int random_high_resist(struct object *obj, int *resist)
 }
 
 
-/**
- * Return the index, i, into the cumulative probability table, tbl, such that
- * tbl[i] <= p < tbl[i + 1].  p must be less than tbl[n - 1] and tbl[0] must be
- * zero.
- */
-static int binary_search_probtable(const uint32_t *tbl, int n, uint32_t p)
-{
-	int ilow = 0, ihigh = n;
-
-	assert(tbl[0] == 0 && tbl[n - 1] > p);
-	while (1) {
-		int imid;
-
-		if (ilow == ihigh - 1) {
-			assert(tbl[ilow] <= p && tbl[ihigh] > p);
-			return ilow;
-		}
-		imid = (ilow + ihigh) / 2;
-		if (tbl[imid] <= p) {
-			ilow = imid;
-		} else {
-			ihigh = imid;
-		}
-	}
-}
-
-
 /**
  * Select an ego-item that fits the object's tval and sval.
  */
 static struct ego_item *ego_find_random(struct object *obj, int level)
 {
+	int first = ego_kind_start[obj->kind->kidx];
+	int last = ego_kind_start[obj->kind->kidx + 1];
 	int i;
 	long total = 0L;
 
 	alloc_entry *table = alloc_ego_table;
 
-	/* Go through all possible ego items and find ones which fit this item */
-	for (i = 0; i < alloc_ego_size; i++) {
-		struct ego_item *ego = &e_info[table[i].index];
+	/* Go through the ego items which fit this item */
+	for (i = first; i < last; i++) {
+		alloc_entry *entry = &table[ego_kind_list[i]];
+		struct ego_item *ego = &e_info[entry->index];
 
 		/* Reset any previous probability of this type being picked */
-		table[i].prob3 = 0;
+		entry->prob3 = 0;
 
 		if (level <= ego->alloc_max) {
 			int ood_chance = MAX(2, (ego->alloc_min - level) / 3);
 			if (level >= ego->alloc_min || one_in_(ood_chance)) {
-				struct poss_item *poss;
-
-				for (poss = ego->poss_items; poss; poss = poss->next)
-					if (poss->kidx == obj->kind->kidx) {
-						table[i].prob3 = table[i].prob2;
-						break;
-					}
+				entry->prob3 = entry->prob2;
 
 				/* Total */
-				total += table[i].prob3;
+				total += entry->prob3;
 			}
 		}
 	}
 
 	if (total) {
 		long value = randint0(total);
-		for (i = 0; i < alloc_ego_size; i++) {
+		for (i = first; i < last; i++) {
+			alloc_entry *entry = &table[ego_kind_list[i]];
+
 			/* Found the entry */
-			if (value < table[i].prob3) {
-				return &e_info[table[i].index];
+			if (value < entry->prob3) {
+				return &e_info[entry->index];
 			} else {
 				/* Decrement */
-				value = value - table[i].prob3;
+				value = value - entry->prob3;
 			}
 		}
 	}
@@ -1063,47 +1049,45 @@ bool kind_is_good(const struct object_kind *kind)
 
 
 /**
- * Choose an object kind of a given tval given a dungeon level.
+ * Get the alias table for object kinds at the given level, building it if
+ * need be.  If good is set, only good kinds are included; if tval is not
+ * zero, only kinds of that tval are.
  */
-static struct object_kind *get_obj_num_by_kind(int level, bool good, int tval)
+static const struct kind_alias *get_kind_alias(int level, bool good, int tval)
 {
-	const uint32_t *objects;
-	uint32_t total, value;
-	int item;
+	struct kind_alias *ka;
+	uint32_t *weight;
+	int *kidx;
+	int item, n = 0;
 
 	assert(level >= 0 && level <= z_info->max_obj_depth);
 	assert(tval >= 0 && tval < TV_MAX);
-	if (good) {
-		objects = obj_alloc_great + level * (z_info->k_max + 1);
-		total = obj_total_tval_great[level * TV_MAX + tval];
-	} else {
-		objects = obj_alloc + level * (z_info->k_max + 1);
-		total = obj_total_tval[level * TV_MAX + tval];
-	}
-
-	/* No appropriate items of that tval */
-	if (!total) return NULL;
-
-	/* Pick an object */
-	value = randint0(total);
+	ka = &obj_alias[(level * 2 + (good ? 1 : 0)) * TV_MAX + tval];
+	if (ka->built) return ka;
 
-	/*
-	 * Find it.  Having a loop to calculate the cumulative probability
-	 * here with only the tval and applying a binary search was slower
-	 * for a test of getting a TV_SWORD from 4.2's available objects.
-	 * So continue to use the O(N) search.
-	 */
+	weight = mem_zalloc(z_info->k_max * sizeof(*weight));
+	kidx = mem_zalloc(z_info->k_max * sizeof(*kidx));
 	for (item = 0; item < z_info->k_max; item++) {
-		if (objkind_byid(item)->tval == tval) {
-			uint32_t prob = objects[item + 1] - objects[item];
+		const struct object_kind *kind = &k_info[item];
 
-			if (value < prob) break;
-			value -= prob;
-		}
+		if (tval && kind->tval != tval) continue;
+		if (level < kind->alloc_min || level > kind->alloc_max) continue;
+		if (kind->alloc_prob <= 0) continue;
+		if (good && !kind_is_good(kind)) continue;
+		weight[n] = kind->alloc_prob;
+		kidx[n] = item;
+		n++;
 	}
+	ka->table = Rand_alias_new(weight, n);
+	if (ka->table) {
+		ka->kidx = mem_zalloc(n * sizeof(*ka->kidx));
+		memcpy(ka->kidx, kidx, n * sizeof(*ka->kidx));
+	}
+	ka->built = true;
+	mem_free(kidx);
+	mem_free(weight);
 
-	/* Return the item index */
-	return objkind_byid(item);
+	return ka;
 }
 
 /**
@@ -1113,9 +1097,7 @@ static struct object_kind *get_obj_num_by_kind(int level, bool good, int tval)
  */
 struct object_kind *get_obj_num(int level, bool good, int tval)
 {
-	const uint32_t *objects;
-	uint32_t value;
-	int item;
+	const struct kind_alias *ka;
 
 	/* Occasional level boost */
 	if ((level > 0) && one_in_(z_info->great_obj))
@@ -1126,23 +1108,12 @@ struct object_kind *get_obj_num(int level, bool good, int tval)
 	level = MIN(level, z_info->max_obj_depth);
 	level = MAX(level, 0);
 
-	if (tval)
-		return get_obj_num_by_kind(level, good, tval);
-
-	objects = (good ? obj_alloc_great : obj_alloc) +
-		level * (z_info->k_max + 1);
+	/* No appropriate items */
+	ka = get_kind_alias(level, good, tval);
+	if (!ka->table) return NULL;
 
-	/* Pick an object. */
-	if (! objects[z_info->k_max]) {
-		return NULL;
-	}
-	value = randint0(objects[z_info->k_max]);
-
-	/* Find it with a binary search. */
-	item = binary_search_probtable(objects, z_info->k_max + 1, value);
-
-	/* Return the item index */
-	return objkind_byid(item);
+	/* Pick an object */
+	return objkind_byid(ka->kidx[Rand_alias(ka->table)]);
 }
 
 
@@ -29,10 +29,10 @@
 
 /**
  * A parser has a list of hooks (which are run across new lines given to
- * parser_parse()) and a list of the set of named values for the current line.
- * Each hook has a list of specs, which are essentially named formal parameters;
- * when we run a particular hook across a line, each spec in the hook is
- * assigned a value.
+ * parser_parse()), a table to find them by directive, and the set of named
+ * values for the current line.  Each hook has an array of specs, which are
+ * essentially named formal parameters; when we run a particular hook across a
+ * line, each spec in the hook is assigned the value in the same position.
  */
 
 enum {
@@ -47,18 +47,16 @@ enum {
 };
 
 struct parser_spec {
-	struct parser_spec *next;
 	int type;
 	const char *name;
 };
 
 struct parser_value {
-	struct parser_spec spec;
 	union {
 		wchar_t cval;
 		int ival;
 		unsigned int uval;
-		char *sval;
+		const char *sval;
 		random_value rval;
 	} u;
 };
@@ -67,8 +65,8 @@ struct parser_hook {
 	struct parser_hook *next;
 	enum parser_error (*func)(struct parser *p);
 	char *dir;
-	struct parser_spec *fhead;
-	struct parser_spec *ftail;
+	struct parser_spec *specs;
+	int nspecs;
 };
 
 struct parser {
@@ -77,39 +75,104 @@ struct parser {
 	unsigned int colno;
 	char errmsg[1024];
 	struct parser_hook *hooks;
-	struct parser_value *fhead;
-	struct parser_value *ftail;
+
+	/* Open-addressed table of the hooks in force, by directive */
+	struct parser_hook **table;
+	size_t table_size;
+	size_t table_count;
+
+	/* The current line, split in place, and the values of its fields */
+	char *line;
+	size_t line_size;
+	struct parser_hook *hook;
+	struct parser_value *values;
+	int nvalues;
+	int values_size;
+
 	void *priv;
 };
 
+#define PARSER_TABLE_INIT 64
+
 /**
  * Allocates a new parser.
  */
 struct parser *parser_new(void) {
 	struct parser *p = mem_zalloc(sizeof *p);
+	p->table_size = PARSER_TABLE_INIT;
+	p->table = mem_zalloc(p->table_size * sizeof(*p->table));
 	return p;
 }
 
+/**
+ * Find the slot in the hook table for directive 'dir'; it holds either the
+ * hook for that directive or NULL.
+ */
+static size_t findslot(struct parser *p, const char *dir) {
+	size_t mask = p->table_size - 1;
+	size_t i = djb2_hash(dir) & mask;
+
+	while (p->table[i] && !streq(p->table[i]->dir, dir))
+		i = (i + 1) & mask;
+	return i;
+}
+
 static struct parser_hook *findhook(struct parser *p, const char *dir) {
-	struct parser_hook *h = p->hooks;
-	while (h) {
-		if (streq(h->dir, dir))
-			break;
-		h = h->next;
+	return p->table[findslot(p, dir)];
+}
+
+/**
+ * Put a hook in the table, superseding any with the same directive.
+ */
+static void addhook(struct parser *p, struct parser_hook *h) {
+	size_t slot;
+
+	/* Keep the table at most half full */
+	if ((p->table_count + 1) * 2 > p->table_size) {
+		struct parser_hook **old = p->table;
+		size_t i, old_size = p->table_size;
+
+		p->table_size *= 2;
+		p->table = mem_zalloc(p->table_size * sizeof(*p->table));
+		for (i = 0; i < old_size; i++) {
+			if (old[i])
+				p->table[findslot(p, old[i]->dir)] = old[i];
+		}
+		mem_free(old);
 	}
-	return h;
+
+	slot = findslot(p, h->dir);
+	if (!p->table[slot])
+		p->table_count++;
+	p->table[slot] = h;
 }
 
-static void parser_freeold(struct parser *p) {
-	struct parser_value *v;
-	while (p->fhead) {
-		int t = p->fhead->spec.type & ~PARSE_T_OPT;
-		v = (struct parser_value *)p->fhead->spec.next;
-		if (t == PARSE_T_SYM || t == PARSE_T_STR)
-			mem_free(p->fhead->u.sval);
-		mem_free(p->fhead);
-		p->fhead = v;
+/**
+ * Split off the next field of the line at '*pos'.  If 'split' is set, empty
+ * fields are skipped and the field runs up to the next ':'; otherwise it is
+ * the whole of the rest of the line.  Returns NULL if nothing is left.
+ */
+static char *nextfield(char **pos, bool split) {
+	char *start = *pos;
+	char *end;
+
+	if (split) {
+		while (*start == ':')
+			start++;
 	}
+	if (!*start) {
+		*pos = start;
+		return NULL;
+	}
+
+	end = split ? strchr(start, ':') : NULL;
+	if (end) {
+		*end = '\0';
+		*pos = end + 1;
+	} else {
+		*pos = start + strlen(start);
+	}
+	return start;
 }
 
 static bool parse_random(const char *str, random_value *bonus) {
@@ -206,24 +269,24 @@ static bool parse_random(const char *str, random_value *bonus) {
  * Parses the provided line.
  *
  * This runs the first parser hook registered with `p` that matches `line`.
+ * The line is copied into a buffer kept by the parser and split up there, so
+ * the values of the fields need no allocation of their own; they last until
+ * the next line is parsed.
  */
 enum parser_error parser_parse(struct parser *p, const char *line) {
-	char *cline;
+	char *pos;
 	char *tok;
 	struct parser_hook *h;
-	struct parser_spec *s;
-	struct parser_value *v;
-	char *sp = NULL;
+	int i;
+	size_t len;
 
 	assert(p);
 	assert(line);
 
-	parser_freeold(p);
-
 	p->lineno++;
 	p->colno = 1;
-	p->fhead = NULL;
-	p->ftail = NULL;
+	p->hook = NULL;
+	p->nvalues = 0;
 
 	/* Ignore empty lines and comments. */
 	while (*line && (isspace(*line)))
@@ -231,11 +294,16 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!*line || *line == '#')
 		return PARSE_ERROR_NONE;
 
-	cline = string_make(line);
+	len = strlen(line) + 1;
+	if (len > p->line_size) {
+		p->line_size = MAX(len, 2 * p->line_size);
+		p->line = mem_realloc(p->line, p->line_size);
+	}
+	memcpy(p->line, line, len);
+	pos = p->line;
 
-	tok = strtok(cline, ":");
+	tok = nextfield(&pos, true);
 	if (!tok) {
-		mem_free(cline);
 		p->error = PARSE_ERROR_MISSING_FIELD;
 		return PARSE_ERROR_MISSING_FIELD;
 	}
@@ -244,15 +312,17 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!h) {
 		my_strcpy(p->errmsg, tok, sizeof(p->errmsg));
 		p->error = PARSE_ERROR_UNDEFINED_DIRECTIVE;
-		mem_free(cline);
 		return PARSE_ERROR_UNDEFINED_DIRECTIVE;
 	}
+	p->hook = h;
 
 	/* There's a little bit of trickiness here to account for optional
 	 * types. The optional flag has a bit assigned to it in the spec's type
 	 * tag; we compute a temporary type for the spec with that flag removed
 	 * and use that instead. */
-	for (s = h->fhead; s; s = s->next) {
+	for (i = 0; i < h->nspecs; i++) {
+		struct parser_spec *s = &h->specs[i];
+		struct parser_value *v = &p->values[i];
 		int t = s->type & ~PARSE_T_OPT;
 		p->colno++;
 
@@ -260,51 +330,40 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		 * at all (i.e., they consume the remainder of the line) */
 		if (t == PARSE_T_INT || t == PARSE_T_SYM || t == PARSE_T_RAND ||
 			t == PARSE_T_UINT) {
-			tok = strtok(sp, ":");
-			sp = NULL;
+			tok = nextfield(&pos, true);
 		} else if (t == PARSE_T_CHAR) {
-			tok = strtok(sp, "");
+			tok = nextfield(&pos, false);
 			if (tok) {
-				sp = utf8_fskip(tok, 1, NULL);
-				if (sp) {
-					if (*sp == ':') {
-						++sp;
-					} else if (*sp) {
+				char *after = utf8_fskip(tok, 1, NULL);
+				if (after) {
+					if (*after == ':') {
+						++after;
+					} else if (*after) {
 						my_strcpy(p->errmsg, s->name,
 							sizeof(p->errmsg));
 						p->error = PARSE_ERROR_FIELD_TOO_LONG;
-						mem_free(cline);
 						return PARSE_ERROR_FIELD_TOO_LONG;
 					}
+					pos = after;
 				}
 			}
 		} else {
-			tok = strtok(sp, "");
-			sp = NULL;
+			tok = nextfield(&pos, false);
 		}
 		if (!tok) {
 			if (!(s->type & PARSE_T_OPT)) {
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_MISSING_FIELD;
-				mem_free(cline);
 				return PARSE_ERROR_MISSING_FIELD;
 			}
 			break;
 		}
 
-		/* Allocate a value node. */
-		v = mem_alloc(sizeof *v);
-		v->spec.next = NULL;
-		v->spec.type = s->type;
-		v->spec.name = s->name;
-
 		/* Parse out its value. */
 		if (t == PARSE_T_INT) {
 			char *z = NULL;
 			v->u.ival = strtol(tok, &z, 0);
 			if (z == tok) {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -313,8 +372,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			char *z = NULL;
 			v->u.uval = strtoul(tok, &z, 0);
 			if (z == tok || *tok == '-') {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -322,27 +379,17 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		} else if (t == PARSE_T_CHAR) {
 			text_mbstowcs(&v->u.cval, tok, 1);
 		} else if (t == PARSE_T_SYM || t == PARSE_T_STR) {
-			v->u.sval = string_make(tok);
+			v->u.sval = tok;
 		} else if (t == PARSE_T_RAND) {
 			if (!parse_random(tok, &v->u.rval)) {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_RANDOM;
 				return PARSE_ERROR_NOT_RANDOM;
 			}
 		}
-
-		/* Link it into the value list. */
-		if (!p->fhead)
-			p->fhead = v;
-		else
-			p->ftail->spec.next = &v->spec;
-		p->ftail = v;
+		p->nvalues = i + 1;
 	}
 
-	mem_free(cline);
-
 	p->error = h->func(p);
 	return p->error;
 }
@@ -385,14 +432,13 @@ static int parse_type(const char *s) {
 }
 
 static void clean_specs(struct parser_hook *h) {
-	struct parser_spec *s;
+	int i;
 	mem_free(h->dir);
-	while (h->fhead) {
-		s = h->fhead;
-		h->fhead = h->fhead->next;
-		mem_free((void*)s->name);
-		mem_free(s);
-	}
+	for (i = 0; i < h->nspecs; i++)
+		mem_free((void*)h->specs[i].name);
+	mem_free(h->specs);
+	h->specs = NULL;
+	h->nspecs = 0;
 }
 
 /**
@@ -400,13 +446,15 @@ static void clean_specs(struct parser_hook *h) {
  */
 void parser_destroy(struct parser *p) {
 	struct parser_hook *h;
-	parser_freeold(p);
 	while (p->hooks) {
 		h = p->hooks->next;
 		clean_specs(p->hooks);
 		mem_free(p->hooks);
 		p->hooks = h;
 	}
+	mem_free(p->table);
+	mem_free(p->values);
+	mem_free(p->line);
 	mem_free(p);
 }
 
@@ -423,8 +471,8 @@ static errr parse_specs(struct parser_hook *h, char *fmt) {
 	if (!name)
 		return -EINVAL;
 	h->dir = string_make(name);
-	h->fhead = NULL;
-	h->ftail = NULL;
+	h->specs = NULL;
+	h->nspecs = 0;
 	while (name) {
 		/* Lack of a type is legal; that means we're at the end of the line. */
 		stype = strtok(NULL, " ");
@@ -445,26 +493,21 @@ static errr parse_specs(struct parser_hook *h, char *fmt) {
 			clean_specs(h);
 			return -EINVAL;
 		}
-		if (!(type & PARSE_T_OPT) && h->ftail &&
-			(h->ftail->type & PARSE_T_OPT)) {
+		s = h->nspecs ? &h->specs[h->nspecs - 1] : NULL;
+		if (!(type & PARSE_T_OPT) && s && (s->type & PARSE_T_OPT)) {
 			clean_specs(h);
 			return -EINVAL;
 		}
-		if (h->ftail && ((h->ftail->type & ~PARSE_T_OPT) == PARSE_T_STR)) {
+		if (s && ((s->type & ~PARSE_T_OPT) == PARSE_T_STR)) {
 			clean_specs(h);
 			return -EINVAL;
 		}
 
 		/* Save this spec. */
-		s = mem_alloc(sizeof *s);
+		h->specs = mem_realloc(h->specs, (h->nspecs + 1) * sizeof(*s));
+		s = &h->specs[h->nspecs++];
 		s->type = type;
 		s->name = string_make(name);
-		s->next = NULL;
-		if (h->fhead)
-			h->ftail->next = s;
-		else
-			h->fhead = s;
-		h->ftail = s;
 	}
 
 	return 0;
@@ -505,7 +548,15 @@ errr parser_reg(struct parser *p, const char *fmt,
 	}
 
 	p->hooks = h;
+	addhook(p, h);
 	mem_free(cfmt);
+
+	/* Make sure there's room for this hook's values */
+	if (h->nspecs > p->values_size) {
+		p->values_size = h->nspecs;
+		p->values = mem_realloc(p->values,
+			p->values_size * sizeof(*p->values));
+	}
 	return 0;
 }
 
@@ -516,37 +567,48 @@ enum parser_error ignored(struct parser *p) {
 	return PARSE_ERROR_NONE;
 }
 
+/**
+ * Find the index of the value named `name` for the current line, or -1 if
+ * there is no such value.  The values are stored in the same order as the
+ * fields of the hook.
+ */
+static int parser_findval(struct parser *p, const char *name) {
+	int i;
+
+	for (i = 0; i < p->nvalues; i++) {
+		if (streq(p->hook->specs[i].name, name))
+			return i;
+	}
+	return -1;
+}
+
 /**
  * Returns whether the parser has a value named `name`.
  *
  * Used to test for presence of optional values.
  */
 bool parser_hasval(struct parser *p, const char *name) {
-	struct parser_value *v;
-	for (v = p->fhead; v; v = (struct parser_value *)v->spec.next) {
-		if (streq(v->spec.name, name))
-			return true;
-	}
-	return false;
+	return parser_findval(p, name) >= 0;
 }
 
-static struct parser_value *parser_getval(struct parser *p, const char *name) {
-	struct parser_value *v;
-	for (v = p->fhead; v; v = (struct parser_value *)v->spec.next) {
-		if (streq(v->spec.name, name)) {
-			return v;
-		}
+static struct parser_value *parser_getval(struct parser *p, const char *name,
+		int type) {
+	int i = parser_findval(p, name);
+
+	if (i < 0) {
+		quit_fmt("parser_getval error: name is %s\n", name);
+		return 0; /* Needed to avoid Windows compiler warning */
 	}
-	quit_fmt("parser_getval error: name is %s\n", name);
-	return 0; /* Needed to avoid Windows compiler warning */
+	assert((p->hook->specs[i].type & ~PARSE_T_OPT) == type);
+	(void) type;
+	return &p->values[i];
 }
 
 /**
  * Returns the symbol named `name`. This symbol must exist.
  */
 const char *parser_getsym(struct parser *p, const char *name) {
-	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_SYM);
+	struct parser_value *v = parser_getval(p, name, PARSE_T_SYM);
 	return v->u.sval;
 }
 
@@ -554,8 +616,7 @@ const char *parser_getsym(struct parser *p, const char *name) {
  * Returns the integer named `name`. This symbol must exist.
  */
 int parser_getint(struct parser *p, const char *name) {
-	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_INT);
+	struct parser_value *v = parser_getval(p, name, PARSE_T_INT);
 	return v->u.ival;
 }
 
@@ -563,8 +624,7 @@ int parser_getint(struct parser *p, const char *name) {
  * Returns the unsigned integer named `name`. This symbol must exist.
  */
 unsigned int parser_getuint(struct parser *p, const char *name) {
-	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_UINT);
+	struct parser_value *v = parser_getval(p, name, PARSE_T_UINT);
 	return v->u.uval;
 }
 
@@ -572,8 +632,7 @@ unsigned int parser_getuint(struct parser *p, const char *name) {
  * Returns the string named `name`. This symbol must exist.
  */
 const char *parser_getstr(struct parser *p, const char *name) {
-	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_STR);
+	struct parser_value *v = parser_getval(p, name, PARSE_T_STR);
 	return v->u.sval;
 }
 
@@ -581,8 +640,7 @@ const char *parser_getstr(struct parser *p, const char *name) {
  * Returns the random value named `name`. This symbol must exist.
  */
 struct random parser_getrand(struct parser *p, const char *name) {
-	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_RAND);
+	struct parser_value *v = parser_getval(p, name, PARSE_T_RAND);
 	return v->u.rval;
 }
 
@@ -590,8 +648,7 @@ struct random parser_getrand(struct parser *p, const char *name) {
  * Returns the character named `name`. This symbol must exist.
  */
 wchar_t parser_getchar(struct parser *p, const char *name) {
-	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_CHAR);
+	struct parser_value *v = parser_getval(p, name, PARSE_T_CHAR);
 	return v->u.cval;
 }
 
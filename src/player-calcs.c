@@ -22,6 +22,7 @@
 #include "cave.h"
 #include "game-event.h"
 #include "game-input.h"
+#include "game-profile.h"
 #include "game-world.h"
 #include "init.h"
 #include "mon-msg.h"
@@ -2536,6 +2537,7 @@ void notice_stuff(struct player *p)
 {
 	/* Notice stuff */
 	if (!p->upkeep->notice) return;
+	profile_enter(PROFILE_NOTICE);
 
 	/* Deal with ignore stuff */
 	if (p->upkeep->notice & PN_IGNORE) {
@@ -2556,6 +2558,7 @@ void notice_stuff(struct player *p)
 		/* Make sure this comes after all of the monster messages */
 		show_monster_messages();
 	}
+	profile_leave(PROFILE_NOTICE);
 }
 
 /**
@@ -2726,7 +2729,15 @@ void redraw_stuff(struct player *p)
  */
 void handle_stuff(struct player *p)
 {
-	if (p->upkeep->update) update_stuff(p);
-	if (p->upkeep->redraw) redraw_stuff(p);
+	if (p->upkeep->update) {
+		profile_enter(PROFILE_UPDATE);
+		update_stuff(p);
+		profile_leave(PROFILE_UPDATE);
+	}
+	if (p->upkeep->redraw) {
+		profile_enter(PROFILE_REDRAW);
+		redraw_stuff(p);
+		profile_leave(PROFILE_REDRAW);
+	}
 }
 
@@ -80,6 +80,218 @@ const char *proj_idx_to_name(int type)
  * ------------------------------------------------------------------------
  * Projection paths
  * ------------------------------------------------------------------------ */
+/**
+ * Precomputed projection paths.
+ *
+ * For every target offset within project_ray_radius of the origin, the
+ * grids of the projection path towards it, relative to the origin, are
+ * stored in order until the path distance reaches the radius.  Alongside
+ * each grid is the distance measure project_path() compares against the
+ * range.  The path for the offset with index i runs from project_ray_start[i]
+ * up to project_ray_start[i + 1].
+ */
+static int project_ray_radius;
+static uint32_t *project_ray_start;
+static int8_t *project_ray_x;
+static int8_t *project_ray_y;
+static uint8_t *project_ray_dist;
+
+/**
+ * Index of a target offset in the projection path table
+ */
+static int project_ray_index(int dx, int dy)
+{
+	return (dy + project_ray_radius) * (2 * project_ray_radius + 1)
+		+ dx + project_ray_radius;
+}
+
+/**
+ * Record the unobstructed projection path, relative to the origin, towards a
+ * target offset.  This follows the stepping of project_path() exactly.
+ * \param dx Is the horizontal offset of the target; dx and dy can not both
+ * be zero.
+ * \param dy Is the vertical offset of the target.
+ * \param range Is the distance at which to stop the path.
+ * \param path Is where the grids are stored; there must be room for range
+ * grids.
+ * \param dist Is where the distance measure for each grid is stored.
+ * \return the number of grids in the path.
+ */
+static int project_ray_trace(int dx, int dy, int range, struct loc *path,
+		int *dist)
+{
+	int ay = ABS(dy), ax = ABS(dx);
+	int sy = (dy < 0) ? -1 : 1, sx = (dx < 0) ? -1 : 1;
+	int half = (ay * ax), full = half << 1;
+	int frac, m, y, x;
+	int n = 0, k = 0;
+
+	if (ay > ax) {
+		/* Vertical */
+		frac = ax * ax;
+		m = frac << 1;
+		y = sy;
+		x = 0;
+		while (1) {
+			path[n++] = loc(x, y);
+			dist[n - 1] = n + (k >> 1);
+			if (dist[n - 1] >= range) break;
+			if (m) {
+				frac += m;
+				if (frac >= half) {
+					x += sx;
+					frac -= full;
+					k++;
+				}
+			}
+			y += sy;
+		}
+	} else if (ax > ay) {
+		/* Horizontal */
+		frac = ay * ay;
+		m = frac << 1;
+		y = 0;
+		x = sx;
+		while (1) {
+			path[n++] = loc(x, y);
+			dist[n - 1] = n + (k >> 1);
+			if (dist[n - 1] >= range) break;
+			if (m) {
+				frac += m;
+				if (frac >= half) {
+					y += sy;
+					frac -= full;
+					k++;
+				}
+			}
+			x += sx;
+		}
+	} else {
+		/* Diagonal */
+		y = sy;
+		x = sx;
+		while (1) {
+			path[n++] = loc(x, y);
+			dist[n - 1] = n + (n >> 1);
+			if (dist[n - 1] >= range) break;
+			y += sy;
+			x += sx;
+		}
+	}
+
+	return n;
+}
+
+/**
+ * Build the projection path table, covering targets and ranges up to the
+ * larger of the maximum sight and maximum projection ranges.
+ */
+static void init_project_rays(void)
+{
+	/*
+	 * The offsets have to fit in a signed byte, which also keeps the
+	 * distances within a byte; project_path() traces further ones
+	 */
+	int radius = MIN(MAX(z_info->max_sight, z_info->max_range), INT8_MAX);
+	int count = (2 * radius + 1) * (2 * radius + 1);
+	struct loc *path = mem_alloc((radius + 1) * sizeof(*path));
+	int *dist = mem_alloc((radius + 1) * sizeof(*dist));
+	uint32_t total = 0;
+	int dx, dy, i;
+
+	assert(radius > 0);
+
+	project_ray_radius = radius;
+	project_ray_start = mem_zalloc((count + 1) * sizeof(*project_ray_start));
+
+	/* Count the grids for each offset */
+	for (dy = -radius; dy <= radius; dy++) {
+		for (dx = -radius; dx <= radius; dx++) {
+			project_ray_start[project_ray_index(dx, dy)] = total;
+			if (dx || dy) {
+				total += project_ray_trace(dx, dy, radius, path, dist);
+			}
+		}
+	}
+	project_ray_start[count] = total;
+
+	/* Fill in the grids */
+	project_ray_x = mem_zalloc(total * sizeof(*project_ray_x));
+	project_ray_y = mem_zalloc(total * sizeof(*project_ray_y));
+	project_ray_dist = mem_zalloc(total * sizeof(*project_ray_dist));
+	for (dy = -radius; dy <= radius; dy++) {
+		for (dx = -radius; dx <= radius; dx++) {
+			uint32_t start = project_ray_start[project_ray_index(dx, dy)];
+			int n;
+
+			if (!dx && !dy) continue;
+			n = project_ray_trace(dx, dy, radius, path, dist);
+			for (i = 0; i < n; i++) {
+				project_ray_x[start + i] = (int8_t) path[i].x;
+				project_ray_y[start + i] = (int8_t) path[i].y;
+				project_ray_dist[start + i] = (uint8_t) dist[i];
+			}
+		}
+	}
+
+	mem_free(dist);
+	mem_free(path);
+}
+
+static void cleanup_project_rays(void)
+{
+	mem_free(project_ray_start);
+	project_ray_start = NULL;
+	mem_free(project_ray_x);
+	project_ray_x = NULL;
+	mem_free(project_ray_y);
+	project_ray_y = NULL;
+	mem_free(project_ray_dist);
+	project_ray_dist = NULL;
+	project_ray_radius = 0;
+}
+
+struct init_module project_path_module = {
+	.name = "project_path",
+	.init = init_project_rays,
+	.cleanup = cleanup_project_rays
+};
+
+/**
+ * Check whether a projection path has to stop at a grid it has entered.
+ * \param c Is the chunk the path is in.
+ * \param grid Is the grid the path has entered (never the initial grid).
+ * \param grid2 Is the target of the path.
+ * \param decoy Is the location of any decoy.
+ * \param flg Are the PROJECT_ flags for the path.
+ */
+static bool project_path_stop(struct chunk *c, struct loc grid,
+		struct loc grid2, struct loc decoy, int flg)
+{
+	/* Sometimes stop at finish grid */
+	if (!(flg & (PROJECT_THRU)))
+		if (loc_eq(grid, grid2)) return true;
+
+	/* Don't stop if making paths through rock for generation */
+	if (!(flg & (PROJECT_ROCK))) {
+		/* Stop at non-initial wall grids, except where that would
+		 * leak info during targetting */
+		if (!(flg & (PROJECT_INFO))) {
+			if (!square_isprojectable(c, grid)) return true;
+		} else if (square_isbelievedwall(c, grid)) {
+			return true;
+		}
+	}
+
+	/* Sometimes stop at non-initial monsters/players, decoys */
+	if (flg & (PROJECT_STOP)) {
+		if (square(c, grid)->mon != 0) return true;
+		if (loc_eq(grid, decoy)) return true;
+	}
+
+	return false;
+}
+
 /**
  * Determine the path taken by a projection.
  *
@@ -119,6 +331,10 @@ const char *proj_idx_to_name(int type)
  *
  * This algorithm is similar to, but slightly different from, the one used
  * by "update_view_los()", and very different from the one used by "los()".
+ *
+ * Targets and ranges within the maximum sight or projection range use the
+ * paths precomputed by init_project_rays(), so only the stopping conditions
+ * need to be checked for each grid.
  */
 int project_path(struct chunk *c, struct loc *gp, int range, struct loc grid1,
 	struct loc grid2, int flg)
@@ -149,6 +365,30 @@ int project_path(struct chunk *c, struct loc *gp, int range, struct loc grid1,
 	/* No path necessary (or allowed) */
 	if (loc_eq(grid1, grid2)) return (0);
 
+	/* Walk the precomputed path, if there is one */
+	if (project_ray_start && range <= project_ray_radius
+			&& ABS(grid2.x - grid1.x) <= project_ray_radius
+			&& ABS(grid2.y - grid1.y) <= project_ray_radius) {
+		int i = project_ray_index(grid2.x - grid1.x, grid2.y - grid1.y);
+		uint32_t j;
+
+		for (j = project_ray_start[i]; j < project_ray_start[i + 1]; j++) {
+			struct loc grid = loc(grid1.x + project_ray_x[j],
+				grid1.y + project_ray_y[j]);
+
+			/* Save grid */
+			gp[n++] = grid;
+
+			/* Check maximum range */
+			if (project_ray_dist[j] >= range) break;
+
+			/* Stop at the target, walls or monsters as the flags require */
+			if (project_path_stop(c, grid, grid2, decoy, flg)) break;
+		}
+
+		return (n);
+	}
+
 
 	/* Analyze "dy" */
 	if (grid2.y < grid1.y) {
@@ -196,27 +436,8 @@ int project_path(struct chunk *c, struct loc *gp, int range, struct loc grid1,
 			/* Hack -- Check maximum range */
 			if ((n + (k >> 1)) >= range) break;
 
-			/* Sometimes stop at finish grid */
-			if (!(flg & (PROJECT_THRU)))
-				if (loc_eq(loc(x, y), grid2)) break;
-
-			/* Don't stop if making paths through rock for generation */
-			if (!(flg & (PROJECT_ROCK))) {
-				/* Stop at non-initial wall grids, except where that would
-				 * leak info during targetting */
-				if (!(flg & (PROJECT_INFO))) {
-					if ((n > 0) && !square_isprojectable(c, loc(x, y)))
-						break;
-				} else if ((n > 0) && square_isbelievedwall(c, loc(x, y))) {
-					break;
-				}
-			}
-
-			/* Sometimes stop at non-initial monsters/players, decoys */
-			if (flg & (PROJECT_STOP)) {
-				if ((n > 0) && (square(c, loc(x, y))->mon != 0)) break;
-				if (loc_eq(loc(x, y), decoy)) break;
-			}
+			/* Stop at the target, walls or monsters as the flags require */
+			if (project_path_stop(c, loc(x, y), grid2, decoy, flg)) break;
 
 			/* Slant */
 			if (m) {
@@ -261,27 +482,8 @@ int project_path(struct chunk *c, struct loc *gp, int range, struct loc grid1,
 			/* Hack -- Check maximum range */
 			if ((n + (k >> 1)) >= range) break;
 
-			/* Sometimes stop at finish grid */
-			if (!(flg & (PROJECT_THRU)))
-				if (loc_eq(loc(x, y), grid2)) break;
-
-			/* Don't stop if making paths through rock for generation */
-			if (!(flg & (PROJECT_ROCK))) {
-				/* Stop at non-initial wall grids, except where that would
-				 * leak info during targetting */
-				if (!(flg & (PROJECT_INFO))) {
-					if ((n > 0) && !square_isprojectable(c, loc(x, y)))
-						break;
-				} else if ((n > 0) && square_isbelievedwall(c, loc(x, y))) {
-					break;
-				}
-			}
-
-			/* Sometimes stop at non-initial monsters/players, decoys */
-			if (flg & (PROJECT_STOP)) {
-				if ((n > 0) && (square(c, loc(x, y))->mon != 0)) break;
-				if (loc_eq(loc(x, y), decoy)) break;
-			}
+			/* Stop at the target, walls or monsters as the flags require */
+			if (project_path_stop(c, loc(x, y), grid2, decoy, flg)) break;
 
 			/* Slant */
 			if (m) {
@@ -320,27 +522,8 @@ int project_path(struct chunk *c, struct loc *gp, int range, struct loc grid1,
 			/* Hack -- Check maximum range */
 			if ((n + (n >> 1)) >= range) break;
 
-			/* Sometimes stop at finish grid */
-			if (!(flg & (PROJECT_THRU)))
-				if (loc_eq(loc(x, y), grid2)) break;
-
-			/* Don't stop if making paths through rock for generation */
-			if (!(flg & (PROJECT_ROCK))) {
-				/* Stop at non-initial wall grids, except where that would
-				 * leak info during targetting */
-				if (!(flg & (PROJECT_INFO))) {
-					if ((n > 0) && !square_isprojectable(c, loc(x, y)))
-						break;
-				} else if ((n > 0) && square_isbelievedwall(c, loc(x, y))) {
-					break;
-				}
-			}
-
-			/* Sometimes stop at non-initial monsters/players, decoys */
-			if (flg & (PROJECT_STOP)) {
-				if ((n > 0) && (square(c, loc(x, y))->mon != 0)) break;
-				if (loc_eq(loc(x, y), decoy)) break;
-			}
+			/* Stop at the target, walls or monsters as the flags require */
+			if (project_path_stop(c, loc(x, y), grid2, decoy, flg)) break;
 
 			/* Advance */
 			y += sy;
@@ -21,29 +21,47 @@
 #include "save-charoutput.h"
 #include "z-file.h"
 
-/* Based on the adaptation of Exo's patch to frogcomposband. */
-bool save_charoutput(void)
+/**
+ * Describe the character in the form written to CharOutput.txt.  The result
+ * should be freed with string_free().
+ *
+ * Based on the adaptation of Exo's patch to frogcomposband.
+ */
+char *charoutput_make(void)
+{
+	char buf[1024];
+
+	strnfmt(buf, sizeof(buf),
+		"{\n"
+		"race: \"%s\",\n"
+		"class: \"%s\",\n"
+		"mapName: \"Angband\",\n"
+		"dLvl: \"%i\",\n"
+		"cLvl: \"%i\",\n"
+		"isDead: \"%i\",\n"
+		"killedBy: \"%s\"\n"
+		"}",
+		player->race->name, player->class->name, player->depth,
+		player->lev, (player->is_dead) ? 1 : 0, player->died_from);
+	return string_make(buf);
+}
+
+/**
+ * Write a description from charoutput_make() to the given file, normally
+ * CharOutput.txt in the user directory.  Does not use any game state, so it
+ * is safe to call while the game carries on.
+ */
+bool charoutput_write(const char *path, const char *text)
 {
-	char path[1024];
 	ang_file *fo;
 	bool written = true;
 
-	path_build(path, sizeof(path), ANGBAND_DIR_USER, "CharOutput.txt");
 	fo = file_open(path, MODE_WRITE, FTYPE_TEXT);
 	if (fo) {
-		if (! file_put(fo, "{\n")) written = false;
-		if (! file_putf(fo, "race: \"%s\",\n", player->race->name)) written = false;
-		if (! file_putf(fo, "class: \"%s\",\n", player->class->name)) written = false;
-		if (! file_put(fo, "mapName: \"Angband\",\n")) written = false;
-		if (! file_putf(fo, "dLvl: \"%i\",\n", player->depth)) written = false;
-		if (! file_putf(fo, "cLvl: \"%i\",\n", player->lev)) written = false;
-		if (! file_putf(fo, "isDead: \"%i\",\n", (player->is_dead) ? 1 : 0)) written = false;
-		if (! file_putf(fo, "killedBy: \"%s\"\n", player->died_from)) written = false;
-		if (! file_put(fo, "}")) written = false;
+		if (! file_put(fo, text)) written = false;
 		if (! file_close(fo)) written = false;
 	} else {
 		written = false;
 	}
 	return written;
 }
-
@@ -7,7 +7,8 @@
 
 #include "h-basic.h"
 
-bool save_charoutput(void);
+char *charoutput_make(void);
+bool charoutput_write(const char *path, const char *text);
 
 #endif /* INCLUDED_SAVE_CHAROUTPUT_H */
 
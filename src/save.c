@@ -23,6 +23,7 @@
 #include "mon-group.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "monster.h"
 #include "object.h"
 #include "obj-desc.h"
@@ -133,8 +134,7 @@ static void wr_item(const struct object *obj)
 	}
 	wr_byte(obj->notice);
 
-	for (i = 0; i < OF_SIZE; i++)
-		wr_byte(obj->flags[i]);
+	wr_bytes(obj->flags, OF_SIZE);
 
 	for (i = 0; i < OBJ_MOD_MAX; i++) {
 		wr_s16b(obj->modifiers[i]);
@@ -225,11 +225,9 @@ static void wr_monster(const struct monster *mon)
 	for (j = 0; j < MON_TMD_MAX; j++)
 		wr_s16b(mon->m_timed[j]);
 
-	for (j = 0; j < MFLAG_SIZE; j++)
-		wr_byte(mon->mflag[j]);
+	wr_bytes(mon->mflag, MFLAG_SIZE);
 
-	for (j = 0; j < OF_SIZE; j++)
-		wr_byte(mon->known_pstate.flags[j]);
+	wr_bytes(mon->known_pstate.flags, OF_SIZE);
 
 	for (j = 0; j < ELEM_MAX; j++)
 		wr_s16b(mon->known_pstate.el_info[j].res_level);
@@ -260,8 +258,6 @@ static void wr_monster(const struct monster *mon)
  */
 static void wr_trap(struct trap *trap)
 {
-	size_t i;
-
 	if (trap->t_idx) {
 		wr_string(trap_info[trap->t_idx].desc);
 	} else {
@@ -272,8 +268,7 @@ static void wr_trap(struct trap *trap)
 	wr_byte(trap->power);
 	wr_byte(trap->timeout);
 
-	for (i = 0; i < TRF_SIZE; i++)
-		wr_byte(trap->flags[i]);
+	wr_bytes(trap->flags, TRF_SIZE);
 }
 
 /**
@@ -766,81 +761,79 @@ void wr_stores(void)
 
 
 
+/**
+ * Write one layer of the level, n grids in row order, as (count, value) runs.
+ * The runs are built up in the caller's scratch space, which must hold
+ * 2 * (n + 1) bytes, and written as a single span.
+ */
+static void wr_layer_rle(const uint8_t *layer, size_t n, uint8_t *runs)
+{
+	size_t i, len = 0;
+	uint8_t count = 0;
+	uint8_t prev_char = 0;
+
+	for (i = 0; i < n; i++) {
+		/* If the run is broken, or too full, flush it */
+		if ((layer[i] != prev_char) || (count == UCHAR_MAX)) {
+			runs[len++] = count;
+			runs[len++] = prev_char;
+			prev_char = layer[i];
+			count = 1;
+		} else /* Continue the run */
+			count++;
+	}
+
+	/* Flush the data (if any) */
+	if (count) {
+		runs[len++] = count;
+		runs[len++] = prev_char;
+	}
+
+	wr_bytes(runs, len);
+}
+
 /**
  * Write the current dungeon terrain features and info flags
  *
  * Note that the cost and when fields of c->squares[y][x] are not saved
+ *
+ * Returns where the runs of info flags start, for cave_unpack() to read them
+ * and the terrain back from a stored level's saved bytes
  */
-static void wr_dungeon_aux(struct chunk *c)
+static uint32_t wr_dungeon_aux(struct chunk *c)
 {
 	int y, x;
-	size_t i;
-
-	uint8_t tmp8u;
-
-	uint8_t count;
-	uint8_t prev_char;
+	size_t i, n = (size_t) c->height * c->width;
+	uint8_t *layer = mem_alloc(MAX(n, 1));
+	uint8_t *runs = mem_alloc(2 * (n + 1));
+	uint32_t squares;
 
 	/* Dungeon specific info follows */
 	wr_string(c->name ? c->name : "Blank");
 	wr_u16b(c->height);
 	wr_u16b(c->width);
+	squares = sf_tell();
 
 	/* Run length encoding of c->squares[y][x].info */
 	for (i = 0; i < SQUARE_SIZE; i++) {
-		count = 0;
-		prev_char = 0;
-
-		/* Dump for each grid */
 		for (y = 0; y < c->height; y++) {
 			for (x = 0; x < c->width; x++) {
-				/* Extract the important c->squares[y][x].info flags */
-				tmp8u = square(c, loc(x, y))->info[i];
-
-				/* If the run is broken, or too full, flush it */
-				if ((tmp8u != prev_char) || (count == UCHAR_MAX)) {
-					wr_byte(count);
-					wr_byte(prev_char);
-					prev_char = tmp8u;
-					count = 1;
-				} else /* Continue the run */
-					count++;
+				layer[y * c->width + x] = square(c, loc(x, y))->info[i];
 			}
 		}
-
-		/* Flush the data (if any) */
-		if (count) {
-			wr_byte(count);
-			wr_byte(prev_char);
-		}
+		wr_layer_rle(layer, n, runs);
 	}
 
 	/* Now the terrain */
-	count = 0;
-	prev_char = 0;
-
-	/* Dump for each grid */
 	for (y = 0; y < c->height; y++) {
 		for (x = 0; x < c->width; x++) {
-			/* Extract a byte */
-			tmp8u = square(c, loc(x, y))->feat;
-
-			/* If the run is broken, or too full, flush it */
-			if ((tmp8u != prev_char) || (count == UCHAR_MAX)) {
-				wr_byte(count);
-				wr_byte(prev_char);
-				prev_char = tmp8u;
-				count = 1;
-			} else /* Continue the run */
-				count++;
+			layer[y * c->width + x] = square(c, loc(x, y))->feat;
 		}
 	}
+	wr_layer_rle(layer, n, runs);
 
-	/* Flush the data (if any) */
-	if (count) {
-		wr_byte(count);
-		wr_byte(prev_char);
-	}
+	mem_free(runs);
+	mem_free(layer);
 
 	/* Write feeling */
 	wr_byte(c->feeling);
@@ -855,9 +848,7 @@ static void wr_dungeon_aux(struct chunk *c)
 				wr_byte(current->grid.x);
 				wr_byte(current->grid.y);
 				wr_byte(current->feat);
-				for (i = 0; i < SQUARE_SIZE; i++) {
-					wr_byte(current->info[i]);
-				}
+				wr_bytes(current->info, SQUARE_SIZE);
 				current = current->next;
 			}
 		}
@@ -865,6 +856,8 @@ static void wr_dungeon_aux(struct chunk *c)
 		/* Write a sentinel byte */
 		wr_byte(0xff);
 	}
+
+	return squares;
 }
 
 /**
@@ -985,6 +978,13 @@ void wr_objects(void)
 
 void wr_monsters(void)
 {
+	int i;
+
+	/* Bring the energy of monsters on the level up to date */
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		sync_monster_energy(cave, cave_monster(cave, i));
+	}
+
 	wr_monsters_aux(cave);
 	wr_monsters_aux(player->cave);
 }
@@ -1010,9 +1010,22 @@ void wr_chunks(void)
 	/* Now write each chunk */
 	for (j = 0; j < chunk_list_max; j++) {
 		struct chunk *c = chunk_list[j];
+		uint32_t start = sf_tell(), squares;
+
+		/*
+		 * Stored levels don't change until they are taken off the list,
+		 * so one written before can be copied as it is
+		 */
+		if (c->saved) {
+			wr_bytes(c->saved, c->saved_len);
+			continue;
+		}
+
+		/* Writing it needs the squares back for a while */
+		cave_unpack(c);
 
 		/* Write the terrain and info */
-		wr_dungeon_aux(c);
+		squares = wr_dungeon_aux(c);
 
 		/* Write the objects */
 		wr_objects_aux(c);
@@ -1041,6 +1054,11 @@ void wr_chunks(void)
 				wr_u16b(c->feat_count[i]);
 			}
 		}
+
+		/* Keep the bytes for next time, and for packing the terrain */
+		c->saved = sf_copy_from(start, &c->saved_len);
+		c->saved_squares = squares - start;
+		cave_pack(c);
 	}
 }
 
@@ -15,14 +15,24 @@
  *    and not for profit purposes provided that this copyright and statement
  *    are included in all such copies.  Other copyrights may also apply.
  */
-#include <errno.h>
 #include "angband.h"
+#include "game-profile.h"
 #include "game-world.h"
 #include "init.h"
 #include "savefile.h"
 #include "save-charoutput.h"
 #include "z-file.h"
 
+/*
+ * Changing privileges affects every thread, so a setgid game writes its
+ * saves on the game thread.
+ */
+#if defined(HAVE_PTHREAD) && !defined(SETGID)
+# define SAVE_IN_BACKGROUND
+# include <pthread.h>
+# include <signal.h>
+#endif
+
 /**
  * The savefile code.
  *
@@ -162,7 +172,6 @@ static uint32_t buffer_pos;
 static uint32_t buffer_check;
 
 #define BUFFER_INITIAL_SIZE		1024
-#define BUFFER_BLOCK_INCREMENT	1024
 
 #define SAVEFILE_HEAD_SIZE		28
 
@@ -187,19 +196,28 @@ void note(const char *message)
  * Base put/get
  * ------------------------------------------------------------------------ */
 
-static void sf_put(uint8_t v)
+/**
+ * Make room for n more bytes in the buffer, doubling its size as needed so
+ * that a large block costs only a few reallocations
+ */
+static void sf_reserve(size_t n)
 {
 	assert(buffer != NULL);
 	assert(buffer_size > 0);
 
-	if (buffer_size == buffer_pos)
-	{
-		buffer_size += BUFFER_BLOCK_INCREMENT;
-		buffer = mem_realloc(buffer, buffer_size);
-	}
+	if (buffer_size - buffer_pos >= n) return;
 
-	assert(buffer_pos < buffer_size);
+	while (buffer_size - buffer_pos < n) {
+		if (buffer_size >= 0x80000000)
+			quit("Savefile block is too large");
+		buffer_size *= 2;
+	}
+	buffer = mem_realloc(buffer, buffer_size);
+}
 
+static void sf_put(uint8_t v)
+{
+	sf_reserve(1);
 	buffer[buffer_pos++] = v;
 	buffer_check += v;
 }
@@ -214,6 +232,17 @@ static uint8_t sf_get(void)
 	return buffer[buffer_pos++];
 }
 
+/**
+ * Add a span of the buffer to the running checksum
+ */
+static void sf_check(uint32_t start, size_t n)
+{
+	const uint8_t *p = buffer + start;
+	uint32_t check = 0;
+
+	while (n--) check += *p++;
+	buffer_check += check;
+}
 
 /**
  * ------------------------------------------------------------------------
@@ -227,8 +256,11 @@ void wr_byte(uint8_t v)
 
 void wr_u16b(uint16_t v)
 {
-	sf_put((uint8_t)(v & 0xFF));
-	sf_put((uint8_t)((v >> 8) & 0xFF));
+	uint8_t bytes[2];
+
+	bytes[0] = (uint8_t)(v & 0xFF);
+	bytes[1] = (uint8_t)((v >> 8) & 0xFF);
+	wr_bytes(bytes, sizeof(bytes));
 }
 
 void wr_s16b(int16_t v)
@@ -238,10 +270,13 @@ void wr_s16b(int16_t v)
 
 void wr_u32b(uint32_t v)
 {
-	sf_put((uint8_t)(v & 0xFF));
-	sf_put((uint8_t)((v >> 8) & 0xFF));
-	sf_put((uint8_t)((v >> 16) & 0xFF));
-	sf_put((uint8_t)((v >> 24) & 0xFF));
+	uint8_t bytes[4];
+
+	bytes[0] = (uint8_t)(v & 0xFF);
+	bytes[1] = (uint8_t)((v >> 8) & 0xFF);
+	bytes[2] = (uint8_t)((v >> 16) & 0xFF);
+	bytes[3] = (uint8_t)((v >> 24) & 0xFF);
+	wr_bytes(bytes, sizeof(bytes));
 }
 
 void wr_s32b(int32_t v)
@@ -251,12 +286,20 @@ void wr_s32b(int32_t v)
 
 void wr_string(const char *str)
 {
-	while (*str)
-	{
-		wr_byte(*str);
-		str++;
-	}
-	wr_byte(*str);
+	/* Include the terminating nul */
+	wr_bytes(str, strlen(str) + 1);
+}
+
+/**
+ * Write n bytes exactly as they are
+ */
+void wr_bytes(const void *data, size_t n)
+{
+	if (!n) return;
+	sf_reserve(n);
+	memcpy(buffer + buffer_pos, data, n);
+	sf_check(buffer_pos, n);
+	buffer_pos += n;
 }
 
 
@@ -267,8 +310,11 @@ void rd_byte(uint8_t *ip)
 
 void rd_u16b(uint16_t *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((uint16_t)(sf_get()) << 8);
+	uint8_t bytes[2];
+
+	rd_bytes(bytes, sizeof(bytes));
+	(*ip) = bytes[0];
+	(*ip) |= ((uint16_t)(bytes[1]) << 8);
 }
 
 void rd_s16b(int16_t *ip)
@@ -278,10 +324,13 @@ void rd_s16b(int16_t *ip)
 
 void rd_u32b(uint32_t *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((uint32_t)(sf_get()) << 8);
-	(*ip) |= ((uint32_t)(sf_get()) << 16);
-	(*ip) |= ((uint32_t)(sf_get()) << 24);
+	uint8_t bytes[4];
+
+	rd_bytes(bytes, sizeof(bytes));
+	(*ip) = bytes[0];
+	(*ip) |= ((uint32_t)(bytes[1]) << 8);
+	(*ip) |= ((uint32_t)(bytes[2]) << 16);
+	(*ip) |= ((uint32_t)(bytes[3]) << 24);
 }
 
 void rd_s32b(int32_t *ip)
@@ -291,28 +340,82 @@ void rd_s32b(int32_t *ip)
 
 void rd_string(char *str, int max)
 {
-	uint8_t tmp8u;
-	int i = 0;
+	const uint8_t *end;
+	size_t len;
 
-	do {
-		rd_byte(&tmp8u);
+	if ((buffer == NULL) || (buffer_pos >= buffer_size))
+		quit("Broken savefile - probably from a development version");
 
-		if (i < max) str[i] = tmp8u;
-		if (!tmp8u) break;
-	} while (++i);
+	/* The string runs up to and including its nul */
+	end = memchr(buffer + buffer_pos, 0, buffer_size - buffer_pos);
+	if (!end)
+		quit("Broken savefile - probably from a development version");
+	len = end - (buffer + buffer_pos) + 1;
 
+	/* Keep as much as fits */
+	memcpy(str, buffer + buffer_pos, MIN(len, (size_t) max));
 	str[max - 1] = '\0';
+
+	sf_check(buffer_pos, len);
+	buffer_pos += len;
+}
+
+/**
+ * Return the position in the current block
+ */
+uint32_t sf_tell(void)
+{
+	return buffer_pos;
+}
+
+/**
+ * Copy the bytes of the current block from start up to the current
+ * position; the copy should be freed with mem_free()
+ */
+uint8_t *sf_copy_from(uint32_t start, uint32_t *len)
+{
+	uint8_t *copy;
+
+	assert(start <= buffer_pos);
+	*len = buffer_pos - start;
+	copy = mem_alloc(MAX(*len, 1));
+	memcpy(copy, buffer + start, *len);
+	return copy;
+}
+
+
+/**
+ * Read n bytes exactly as they were written
+ */
+void rd_bytes(void *data, size_t n)
+{
+	if (!n) return;
+	if ((buffer == NULL) || (buffer_pos >= buffer_size)
+			|| (n > buffer_size - buffer_pos))
+		quit("Broken savefile - probably from a development version");
+
+	memcpy(data, buffer + buffer_pos, n);
+	sf_check(buffer_pos, n);
+	buffer_pos += n;
 }
 
 void strip_bytes(int n)
 {
-	uint8_t tmp8u;
-	while (n--) rd_byte(&tmp8u);
+	if (n <= 0) return;
+	if ((buffer == NULL) || (buffer_pos >= buffer_size)
+			|| ((size_t) n > buffer_size - buffer_pos))
+		quit("Broken savefile - probably from a development version");
+
+	sf_check(buffer_pos, n);
+	buffer_pos += n;
 }
 
 void pad_bytes(int n)
 {
-	while (n--) wr_byte(0);
+	if (n <= 0) return;
+	sf_reserve(n);
+	memset(buffer + buffer_pos, 0, n);
+	buffer_pos += n;
 }
 
 
@@ -322,11 +425,47 @@ void pad_bytes(int n)
  * ------------------------------------------------------------------------ */
 
 
-static bool try_save(ang_file *file)
+/**
+ * A complete savefile, held in memory until it is written out
+ */
+struct savefile_image {
+	char path[1024];
+	char new_savefile[1024];
+	char old_savefile[1024];
+	char charoutput_path[1024];
+	char *charoutput;
+	uint8_t *data;
+	size_t size;
+	size_t len;
+	int32_t turn;
+	bool written;
+	bool saved;
+};
+
+/**
+ * Append n bytes to a savefile image
+ */
+static void image_put(struct savefile_image *image, const void *data, size_t n)
+{
+	if (image->size - image->len < n) {
+		while (image->size - image->len < n)
+			image->size *= 2;
+		image->data = mem_realloc(image->data, image->size);
+	}
+	memcpy(image->data + image->len, data, n);
+	image->len += n;
+}
+
+/**
+ * Serialize every block of the game into a savefile image
+ */
+static void try_save(struct savefile_image *image)
 {
 	uint8_t savefile_head[SAVEFILE_HEAD_SIZE];
 	size_t i, pos;
-	bool success = true;
+
+	image_put(image, savefile_magic, 4);
+	image_put(image, savefile_name, 4);
 
 	/* Start off the buffer */
 	buffer = mem_alloc(BUFFER_INITIAL_SIZE);
@@ -357,77 +496,99 @@ static bool try_save(ang_file *file)
 
 		assert(pos == SAVEFILE_HEAD_SIZE);
 
-		if (! file_write(file, (char *)savefile_head,
-				SAVEFILE_HEAD_SIZE)) {
-			success = false;
-		}
-		if (! file_write(file, (char *)buffer, buffer_pos)) {
-			success = false;
-		}
+		image_put(image, savefile_head, SAVEFILE_HEAD_SIZE);
+		image_put(image, buffer, buffer_pos);
 
 		/* pad to 4 byte multiples */
 		if (buffer_pos % 4) {
-			if (! file_write(file, "xxx", 4 - (buffer_pos % 4))) {
-				success = false;
-			}
+			image_put(image, "xxx", 4 - (buffer_pos % 4));
 		}
 	}
 
 	mem_free(buffer);
-
-	return success;
+	buffer = NULL;
 }
 
 /**
- * Attempt to save the player in a savefile
+ * Take everything needed to save the player, so that writing it out no
+ * longer depends on the game
  */
-bool savefile_save(const char *path)
+static struct savefile_image *savefile_image_make(const char *path)
 {
-	ang_file *file;
-	char new_savefile[1024];
-	char old_savefile[1024];
+	struct savefile_image *image = mem_zalloc(sizeof(*image));
+
+	profile_enter(PROFILE_SAVE);
+	my_strcpy(image->path, path, sizeof(image->path));
+	safe_setuid_grab();
+	file_get_savefile(image->old_savefile, sizeof(image->old_savefile),
+		path, "old");
+	file_get_savefile(image->new_savefile, sizeof(image->new_savefile),
+		path, "new");
+	safe_setuid_drop();
 
 	/* Generate a CharOutput.txt, mainly for angband.live, when saving. */
-	(void) save_charoutput();
+	path_build(image->charoutput_path, sizeof(image->charoutput_path),
+		ANGBAND_DIR_USER, "CharOutput.txt");
+	image->charoutput = charoutput_make();
+	image->turn = turn;
 
-	/* New savefile */
-	safe_setuid_grab();
-	file_get_savefile(old_savefile, sizeof(old_savefile), path, "old");
+	image->size = BUFFER_INITIAL_SIZE * 64;
+	image->data = mem_alloc(image->size);
+	try_save(image);
+	profile_leave(PROFILE_SAVE);
 
-	/* Open the savefile */
-        file_get_savefile(new_savefile, sizeof(new_savefile), path, "new");
+	return image;
+}
+
+static void savefile_image_free(struct savefile_image *image)
+{
+	string_free(image->charoutput);
+	mem_free(image->data);
+	mem_free(image);
+}
+
+/**
+ * Write a savefile image to disk, keeping the old savefile until the new one
+ * is safely in place.  This only uses the image and the file system, so it
+ * can run alongside the game; the privileges it grabs are only real in a
+ * setgid game, which never writes in the background.
+ */
+static bool savefile_image_write(struct savefile_image *image)
+{
+	ang_file *file;
+
+	(void) charoutput_write(image->charoutput_path, image->charoutput);
 
-	file = file_open(new_savefile, MODE_WRITE, FTYPE_SAVE);
+	/* Open the savefile */
+	safe_setuid_grab();
+	file = file_open(image->new_savefile, MODE_WRITE, FTYPE_SAVE);
 	safe_setuid_drop();
 
 	if (file) {
-		if (file_write(file, (char *) &savefile_magic, 4)
-			&& file_write(file, (char *) &savefile_name, 4)) {
-			character_saved = try_save(file);
-		} else {
-			character_saved = false;
-		}
+		image->written = file_write(file, (char *) image->data,
+			image->len);
 		file_close(file);
 	} else {
-		character_saved = false;
+		image->written = false;
 	}
 
-	if (character_saved) {
+	if (image->written) {
 		bool err = false;
 
 		safe_setuid_grab();
 
-		if (file_exists(path) && !file_move(path, old_savefile))
+		if (file_exists(image->path)
+				&& !file_move(image->path, image->old_savefile))
 			err = true;
 
 		if (!err) {
-			if (!file_move(new_savefile, path))
+			if (!file_move(image->new_savefile, image->path))
 				err = true;
 
 			if (err)
-				file_move(old_savefile, path);
+				file_move(image->old_savefile, image->path);
 			else
-				file_delete(old_savefile);
+				file_delete(image->old_savefile);
 		} 
 
 		safe_setuid_drop();
@@ -440,13 +601,159 @@ bool savefile_save(const char *path)
 		/* File is no longer valid, but it still points to a non zero
 		 * value if the file was created above */
 		safe_setuid_grab();
-		file_delete(new_savefile);
+		file_delete(image->new_savefile);
 		safe_setuid_drop();
 	}
 	return false;
 }
 
 
+/**
+ * ------------------------------------------------------------------------
+ * Background saving
+ *
+ * With threads, savefile_save_background() only serializes the game on the
+ * game thread.  A writer thread then writes out the file and CharOutput.txt
+ * so that slow disks do not hold up play.  There is at most one writer at a
+ * time; any other save waits for it first, and so does exit().
+ * ------------------------------------------------------------------------ */
+
+#ifdef SAVE_IN_BACKGROUND
+
+static pthread_t writer;
+static bool writer_running;
+static struct savefile_image *writer_image;
+static bool writer_result = true;
+
+static void *savefile_writer(void *arg)
+{
+	struct savefile_image *image = arg;
+
+	image->saved = savefile_image_write(image);
+	return NULL;
+}
+
+/**
+ * Wait for the writer thread, if there is one, and collect its result
+ */
+static void savefile_wait(void)
+{
+	if (!writer_running) return;
+
+	/* A signal handled on the writer itself cannot wait for it */
+	if (pthread_equal(pthread_self(), writer)) return;
+
+	writer_running = false;
+	if (pthread_join(writer, NULL) != 0 || !writer_image->saved) {
+		writer_result = false;
+	} else if (writer_image->turn == turn) {
+		/* Nothing has happened in the game since it was taken */
+		character_saved = true;
+	}
+	savefile_image_free(writer_image);
+	writer_image = NULL;
+}
+
+static void savefile_wait_at_exit(void)
+{
+	savefile_wait();
+}
+
+/**
+ * Hand an image over to a new writer thread
+ */
+static bool savefile_start_writer(struct savefile_image *image)
+{
+	static bool registered = false;
+	sigset_t all, old;
+	int err;
+
+	if (!registered) {
+		if (atexit(savefile_wait_at_exit) != 0) return false;
+		registered = true;
+	}
+
+	/* Leave signals to the game thread, which can make a panic save */
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	err = pthread_create(&writer, NULL, savefile_writer, image);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (err) return false;
+
+	writer_running = true;
+	writer_image = image;
+	return true;
+}
+
+#else /* SAVE_IN_BACKGROUND */
+
+static bool writer_result = true;
+
+static void savefile_wait(void)
+{
+}
+
+#endif /* SAVE_IN_BACKGROUND */
+
+/**
+ * Attempt to save the player in a savefile
+ */
+bool savefile_save(const char *path)
+{
+	struct savefile_image *image;
+	bool result;
+
+	/* Don't let an earlier save overwrite this one */
+	savefile_wait();
+
+	image = savefile_image_make(path);
+	result = savefile_image_write(image);
+	character_saved = image->written;
+	savefile_image_free(image);
+
+	return result;
+}
+
+/**
+ * Save the player in a savefile, doing the writing in the background where
+ * that is possible.  savefile_flush() reports whether the writing worked.
+ */
+void savefile_save_background(const char *path)
+{
+	struct savefile_image *image;
+
+	savefile_wait();
+
+	image = savefile_image_make(path);
+#ifdef SAVE_IN_BACKGROUND
+	if (savefile_start_writer(image)) {
+		/* It isn't saved until the writer says so */
+		character_saved = false;
+		return;
+	}
+#endif
+
+	/* No writer thread, so write it here */
+	if (!savefile_image_write(image)) writer_result = false;
+	character_saved = image->written;
+	savefile_image_free(image);
+}
+
+/**
+ * Wait for any save being written in the background.  Returns false if
+ * writing a background save has failed since the last call.
+ */
+bool savefile_flush(void)
+{
+	bool result;
+
+	savefile_wait();
+	result = writer_result;
+	writer_result = true;
+	return result;
+}
+
+
 
 /**
  * ------------------------------------------------------------------------
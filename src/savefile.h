@@ -37,6 +37,18 @@ extern bool character_saved;
  */
 bool savefile_save(const char *path);
 
+/**
+ * Save to the given location, leaving the writing of the file to a
+ * background thread where possible.
+ */
+void savefile_save_background(const char *path);
+
+/**
+ * Finish any background save.  Returns false if one has failed since the
+ * last call, true otherwise.
+ */
+bool savefile_flush(void);
+
 /**
  * Load the savefile given.  Returns true on succcess, false otherwise.
  */
@@ -69,6 +81,7 @@ void wr_s16b(int16_t v);
 void wr_u32b(uint32_t v);
 void wr_s32b(int32_t v);
 void wr_string(const char *str);
+void wr_bytes(const void *data, size_t n);
 void pad_bytes(int n);
 
 /* Reading bits */
@@ -78,8 +91,13 @@ void rd_s16b(int16_t *ip);
 void rd_u32b(uint32_t *ip);
 void rd_s32b(int32_t *ip);
 void rd_string(char *str, int max);
+void rd_bytes(void *data, size_t n);
 void strip_bytes(int n);
 
+/* Spans of the current block */
+uint32_t sf_tell(void);
+uint8_t *sf_copy_from(uint32_t start, uint32_t *len);
+
 
 
 /* load.c */
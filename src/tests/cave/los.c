@@ -0,0 +1,219 @@
+/* cave/los */
+/* Check that the precomputed rays give the same results as stepping */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "init.h"
+#include "project.h"
+#include "z-rand.h"
+
+extern struct init_module los_module;
+extern struct init_module project_path_module;
+
+#define LOS_TEST_SIZE 61
+
+static struct chunk *create_random_cave(int height, int width) {
+	struct chunk *c = cave_new(height, width);
+	struct loc grid;
+
+	for (grid.y = 0; grid.y < height; ++grid.y) {
+		for (grid.x = 0; grid.x < width; ++grid.x) {
+			if (!square_in_bounds_fully(c, grid)) {
+				square_set_feat(c, grid, FEAT_PERM);
+			} else if (one_in_(4)) {
+				square_set_feat(c, grid, FEAT_GRANITE);
+			} else if (one_in_(20)) {
+				square_set_feat(c, grid, FEAT_RUBBLE);
+			} else {
+				square_set_feat(c, grid, FEAT_FLOOR);
+				if (one_in_(15)) {
+					square_set_mon(c, grid, 1);
+				}
+			}
+		}
+	}
+	return c;
+}
+
+int setup_tests(void **state) {
+	/* Need to initialize the terrain information and the ray tables. */
+	set_file_paths();
+	if (!init_angband()) {
+		*state = NULL;
+		return 1;
+	}
+
+	Rand_state_init(42);
+	*state = create_random_cave(LOS_TEST_SIZE, LOS_TEST_SIZE);
+
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	struct chunk *c = state;
+	struct loc grid;
+
+	for (grid.y = 0; grid.y < c->height; ++grid.y) {
+		for (grid.x = 0; grid.x < c->width; ++grid.x) {
+			square_set_mon(c, grid, 0);
+		}
+	}
+	cave_free(c);
+	cleanup_angband();
+	return 0;
+}
+
+static const struct loc origins[] = {
+	{ LOS_TEST_SIZE / 2, LOS_TEST_SIZE / 2 },
+	{ 1, 1 },
+	{ LOS_TEST_SIZE - 2, 7 },
+	{ 12, LOS_TEST_SIZE - 3 },
+	{ 25, 20 },
+};
+
+static int test_los(void *state) {
+	struct chunk *c = state;
+	int n = (int) N_ELEMENTS(origins) * LOS_TEST_SIZE * LOS_TEST_SIZE;
+	bool *with_table = mem_alloc(n * sizeof(*with_table));
+	struct loc grid;
+	int i, j;
+	bool same = true;
+
+	/* Record the results using the precomputed rays */
+	for (i = 0, j = 0; i < (int) N_ELEMENTS(origins); ++i) {
+		for (grid.y = 0; grid.y < c->height; ++grid.y) {
+			for (grid.x = 0; grid.x < c->width; ++grid.x) {
+				with_table[j++] = los(c, origins[i], grid);
+			}
+		}
+	}
+
+	/* Compare to stepping along the line */
+	los_module.cleanup();
+	for (i = 0, j = 0; i < (int) N_ELEMENTS(origins); ++i) {
+		for (grid.y = 0; grid.y < c->height; ++grid.y) {
+			for (grid.x = 0; grid.x < c->width; ++grid.x) {
+				if (los(c, origins[i], grid) != with_table[j++]) {
+					same = false;
+				}
+			}
+		}
+	}
+	los_module.init();
+
+	mem_free(with_table);
+	require(same);
+	ok;
+}
+
+/**
+ * Reduce a projection path to a single number for comparison
+ */
+static uint32_t hash_path(const struct loc *path, int n) {
+	uint32_t hash = (uint32_t) n;
+	int i;
+
+	for (i = 0; i < n; ++i) {
+		hash = hash * 31 + (uint32_t) (path[i].x * 256 + path[i].y);
+	}
+	return hash;
+}
+
+static int test_project_path(void *state) {
+	const int flags[] = {
+		0, PROJECT_THRU, PROJECT_STOP, PROJECT_THRU | PROJECT_STOP,
+		PROJECT_ROCK, PROJECT_ROCK | PROJECT_THRU
+	};
+	const int ranges[] = {
+		0, 1, z_info->max_range / 4, z_info->max_sight, z_info->max_range
+	};
+	int n = (int) N_ELEMENTS(origins) * (int) N_ELEMENTS(flags)
+		* (int) N_ELEMENTS(ranges) * LOS_TEST_SIZE * LOS_TEST_SIZE;
+	uint32_t *with_table = mem_alloc(n * sizeof(*with_table));
+	struct chunk *c = state;
+	struct loc path[256], grid;
+	int i, j, k, m, path_n;
+	bool same = true;
+
+	/* Record the paths using the precomputed rays */
+	for (i = 0, m = 0; i < (int) N_ELEMENTS(origins); ++i) {
+		for (j = 0; j < (int) N_ELEMENTS(flags); ++j) {
+			for (k = 0; k < (int) N_ELEMENTS(ranges); ++k) {
+				for (grid.y = 0; grid.y < c->height; ++grid.y) {
+					for (grid.x = 0; grid.x < c->width; ++grid.x) {
+						path_n = project_path(c, path, ranges[k],
+							origins[i], grid, flags[j]);
+						with_table[m++] = hash_path(path, path_n);
+					}
+				}
+			}
+		}
+	}
+
+	/* Compare to stepping along the path */
+	project_path_module.cleanup();
+	for (i = 0, m = 0; i < (int) N_ELEMENTS(origins); ++i) {
+		for (j = 0; j < (int) N_ELEMENTS(flags); ++j) {
+			for (k = 0; k < (int) N_ELEMENTS(ranges); ++k) {
+				for (grid.y = 0; grid.y < c->height; ++grid.y) {
+					for (grid.x = 0; grid.x < c->width; ++grid.x) {
+						path_n = project_path(c, path, ranges[k],
+							origins[i], grid, flags[j]);
+						if (hash_path(path, path_n) != with_table[m++]) {
+							same = false;
+						}
+					}
+				}
+			}
+		}
+	}
+	project_path_module.init();
+
+	mem_free(with_table);
+	require(same);
+	ok;
+}
+
+static int test_projectable(void *state) {
+	struct chunk *c = state;
+	int n = (int) N_ELEMENTS(origins) * LOS_TEST_SIZE * LOS_TEST_SIZE;
+	bool *with_table = mem_alloc(n * sizeof(*with_table));
+	struct loc grid;
+	int i, j;
+	bool same = true;
+
+	for (i = 0, j = 0; i < (int) N_ELEMENTS(origins); ++i) {
+		for (grid.y = 0; grid.y < c->height; ++grid.y) {
+			for (grid.x = 0; grid.x < c->width; ++grid.x) {
+				with_table[j++] = projectable(c, origins[i], grid,
+					PROJECT_NONE);
+			}
+		}
+	}
+
+	project_path_module.cleanup();
+	for (i = 0, j = 0; i < (int) N_ELEMENTS(origins); ++i) {
+		for (grid.y = 0; grid.y < c->height; ++grid.y) {
+			for (grid.x = 0; grid.x < c->width; ++grid.x) {
+				if (projectable(c, origins[i], grid, PROJECT_NONE)
+						!= with_table[j++]) {
+					same = false;
+				}
+			}
+		}
+	}
+	project_path_module.init();
+
+	mem_free(with_table);
+	require(same);
+	ok;
+}
+
+const char *suite_name = "cave/los";
+struct test tests[] = {
+	{ "los", test_los },
+	{ "project_path", test_project_path },
+	{ "projectable", test_projectable },
+	{ NULL, NULL }
+};
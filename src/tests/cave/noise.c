@@ -0,0 +1,125 @@
+/* cave/noise */
+/* Check that the bounded noise field matches a full recompute */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "game-world.h"
+#include "init.h"
+#include "mon-move.h"
+#include "player.h"
+#include "player-timed.h"
+#include "z-rand.h"
+
+/* Wide enough that the edge of the level is out of earshot */
+#define NOISE_TEST_HEIGHT 40
+#define NOISE_TEST_WIDTH 150
+#define NOISE_TEST_TURNS 500
+
+struct noise_state {
+	struct chunk *c;
+	struct player *p;
+};
+
+int setup_tests(void **state) {
+	struct noise_state *ns;
+	struct loc grid;
+
+	/* Need the terrain information */
+	set_file_paths();
+	if (!init_angband()) {
+		*state = NULL;
+		return 1;
+	}
+
+	Rand_state_init(23);
+	ns = mem_zalloc(sizeof(*ns));
+	ns->c = cave_new(NOISE_TEST_HEIGHT, NOISE_TEST_WIDTH);
+	for (grid.y = 0; grid.y < NOISE_TEST_HEIGHT; ++grid.y) {
+		for (grid.x = 0; grid.x < NOISE_TEST_WIDTH; ++grid.x) {
+			if (!square_in_bounds_fully(ns->c, grid)) {
+				square_set_feat(ns->c, grid, FEAT_PERM);
+			} else if (one_in_(4)) {
+				square_set_feat(ns->c, grid, FEAT_GRANITE);
+			} else {
+				square_set_feat(ns->c, grid, FEAT_FLOOR);
+			}
+		}
+	}
+	ns->p = mem_zalloc(sizeof(*ns->p));
+	ns->p->timed = mem_zalloc(TMD_MAX * sizeof(*ns->p->timed));
+	ns->p->grid = loc(NOISE_TEST_WIDTH / 2, NOISE_TEST_HEIGHT / 2);
+	square_set_feat(ns->c, ns->p->grid, FEAT_FLOOR);
+	cave = ns->c;
+	*state = ns;
+
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	struct noise_state *ns = state;
+
+	cave = NULL;
+	mem_free(ns->p->timed);
+	mem_free(ns->p);
+	cave_free(ns->c);
+	mem_free(ns);
+	cleanup_angband();
+	return 0;
+}
+
+static int test_bounded(void *state) {
+	struct noise_state *ns = state;
+	int step, bad = 0, loudest = 0;
+	struct loc grid;
+
+	for (step = 0; step < NOISE_TEST_TURNS; ++step) {
+		struct loc next;
+
+		/* Wander, sometimes teleporting or covering tracks */
+		if (one_in_(50)) {
+			next = loc(randint1(NOISE_TEST_WIDTH - 2),
+				randint1(NOISE_TEST_HEIGHT - 2));
+		} else {
+			next = loc_sum(ns->p->grid, ddgrid_ddd[randint0(8)]);
+		}
+		if (square_in_bounds_fully(ns->c, next)
+				&& square_ispassable(ns->c, next)) {
+			ns->p->grid = next;
+		}
+		if (one_in_(40)) {
+			ns->p->timed[TMD_COVERTRACKS] = randint1(20);
+		} else if (ns->p->timed[TMD_COVERTRACKS]) {
+			ns->p->timed[TMD_COVERTRACKS]--;
+		}
+
+		/* Dig out or fill in a grid now and then */
+		grid = loc(randint1(NOISE_TEST_WIDTH - 2),
+			randint1(NOISE_TEST_HEIGHT - 2));
+		if (one_in_(3) && !loc_eq(grid, ns->p->grid)) {
+			square_set_feat(ns->c, grid, square_ispassable(ns->c, grid) ?
+				FEAT_GRANITE : FEAT_FLOOR);
+		}
+
+		make_noise(ns->p);
+		bad += check_noise(ns->c, ns->p);
+
+		/* Note how far the noise went */
+		for (grid.y = 0; grid.y < NOISE_TEST_HEIGHT; ++grid.y) {
+			for (grid.x = 0; grid.x < NOISE_TEST_WIDTH; ++grid.x) {
+				loudest = MAX(loudest,
+					ns->c->noise.grids[grid.y][grid.x]);
+			}
+		}
+	}
+	eq(bad, 0);
+	/* The field reached the edge of earshot, with the level beyond it */
+	require(loudest >= MON_WAKE_NOISE);
+	ok;
+}
+
+const char *suite_name = "cave/noise";
+struct test tests[] = {
+	{ "bounded", test_bounded },
+	{ NULL, NULL }
+};
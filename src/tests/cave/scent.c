@@ -0,0 +1,212 @@
+/* cave/scent */
+/* Check that the stamped scent map ages like the old per-grid counters */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "game-world.h"
+#include "init.h"
+#include "player.h"
+#include "player-timed.h"
+#include "z-rand.h"
+
+#define SCENT_TEST_SIZE 40
+#define SCENT_TEST_TURNS 3000
+
+struct scent_state {
+	struct chunk *c;
+	struct player *p;
+	uint16_t **old;
+};
+
+int setup_tests(void **state) {
+	struct scent_state *ss;
+	struct loc grid;
+
+	/* Need the terrain information */
+	set_file_paths();
+	if (!init_angband()) {
+		*state = NULL;
+		return 1;
+	}
+
+	Rand_state_init(17);
+	ss = mem_zalloc(sizeof(*ss));
+	ss->c = cave_new(SCENT_TEST_SIZE, SCENT_TEST_SIZE);
+	for (grid.y = 0; grid.y < SCENT_TEST_SIZE; ++grid.y) {
+		for (grid.x = 0; grid.x < SCENT_TEST_SIZE; ++grid.x) {
+			if (!square_in_bounds_fully(ss->c, grid)) {
+				square_set_feat(ss->c, grid, FEAT_PERM);
+			} else if (one_in_(5)) {
+				square_set_feat(ss->c, grid, FEAT_GRANITE);
+			} else {
+				square_set_feat(ss->c, grid, FEAT_FLOOR);
+			}
+		}
+	}
+	ss->p = mem_zalloc(sizeof(*ss->p));
+	ss->p->timed = mem_zalloc(TMD_MAX * sizeof(*ss->p->timed));
+	ss->p->grid = loc(SCENT_TEST_SIZE / 2, SCENT_TEST_SIZE / 2);
+	ss->old = mem_zalloc(SCENT_TEST_SIZE * sizeof(*ss->old));
+	for (grid.y = 0; grid.y < SCENT_TEST_SIZE; ++grid.y) {
+		ss->old[grid.y] = mem_zalloc(SCENT_TEST_SIZE * sizeof(**ss->old));
+	}
+	*state = ss;
+
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	struct scent_state *ss = state;
+	int y;
+
+	for (y = 0; y < SCENT_TEST_SIZE; ++y) {
+		mem_free(ss->old[y]);
+	}
+	mem_free(ss->old);
+	mem_free(ss->p->timed);
+	mem_free(ss->p);
+	cave_free(ss->c);
+	mem_free(ss);
+	cleanup_angband();
+	return 0;
+}
+
+/**
+ * The scent update as it was done before stamping, aging every grid
+ */
+static void old_update_scent(struct scent_state *ss)
+{
+	struct chunk *c = ss->c;
+	struct player *p = ss->p;
+	int y, x;
+	int scent_strength[5][5] = {
+		{2, 2, 2, 2, 2},
+		{2, 1, 1, 1, 2},
+		{2, 1, 0, 1, 2},
+		{2, 1, 1, 1, 2},
+		{2, 2, 2, 2, 2},
+	};
+
+	for (y = 1; y < c->height - 1; y++) {
+		for (x = 1; x < c->width - 1; x++) {
+			if (ss->old[y][x] > 0) {
+				ss->old[y][x]++;
+			}
+		}
+	}
+
+	if (p->timed[TMD_COVERTRACKS]) return;
+
+	for (y = 0; y < 5; y++) {
+		for (x = 0; x < 5; x++) {
+			struct loc scent;
+			int new_scent = scent_strength[y][x];
+			int d;
+			bool add_scent = false;
+
+			scent.y = y + p->grid.y - 2;
+			scent.x = x + p->grid.x - 2;
+			if (!square_in_bounds(c, scent)) continue;
+			if (square_isnoscent(c, scent)) continue;
+			for (d = 0; d < 8; d++)	{
+				struct loc adj = loc_sum(scent, ddgrid_ddd[d]);
+
+				if (!square_in_bounds(c, adj)) continue;
+				if (x == 2 && y == 2) add_scent = true;
+				if (ss->old[adj.y][adj.x] == new_scent - 1) {
+					add_scent = true;
+				}
+			}
+			if (!add_scent) continue;
+			ss->old[scent.y][scent.x] = new_scent;
+		}
+	}
+}
+
+/**
+ * Where a monster with the given smell at grid would head for by scent,
+ * following get_move_advance(); returns false if it can't smell anything
+ */
+static bool scent_target(struct scent_state *ss, bool stamped, int smell,
+		struct loc grid, struct loc *target)
+{
+	int here = stamped ? square_scent(ss->c, grid) : ss->old[grid.y][grid.x];
+	int best_scent = 0;
+	bool found = false;
+	int i;
+
+	if (here == 0 || smell <= here) return false;
+	for (i = 0; i < 8; i++) {
+		struct loc adj = loc_sum(grid, ddgrid_ddd[i]);
+		int scent = stamped ?
+			square_scent(ss->c, adj) : ss->old[adj.y][adj.x];
+
+		if (smell - scent > best_scent && scent != 0) {
+			best_scent = smell - scent;
+			*target = adj;
+			found = true;
+		}
+	}
+	return found;
+}
+
+static int test_tracking(void *state) {
+	struct scent_state *ss = state;
+	const int smells[] = { 5, 10, 20, 30 };
+	int step, i, scent_mismatch = 0, track_mismatch = 0;
+	struct loc grid;
+
+	for (step = 0; step < SCENT_TEST_TURNS; ++step) {
+		struct loc next;
+
+		/* Wander, sometimes teleporting or covering tracks */
+		if (one_in_(200)) {
+			next = loc(randint1(SCENT_TEST_SIZE - 2),
+				randint1(SCENT_TEST_SIZE - 2));
+		} else {
+			next = loc_sum(ss->p->grid, ddgrid_ddd[randint0(8)]);
+		}
+		if (square_in_bounds_fully(ss->c, next)
+				&& square_ispassable(ss->c, next)) {
+			ss->p->grid = next;
+		}
+		if (one_in_(150)) {
+			ss->p->timed[TMD_COVERTRACKS] = randint1(20);
+		} else if (ss->p->timed[TMD_COVERTRACKS]) {
+			ss->p->timed[TMD_COVERTRACKS]--;
+		}
+
+		update_scent(ss->c, ss->p);
+		old_update_scent(ss);
+
+		for (grid.y = 1; grid.y < SCENT_TEST_SIZE - 1; ++grid.y) {
+			for (grid.x = 1; grid.x < SCENT_TEST_SIZE - 1; ++grid.x) {
+				if (square_scent(ss->c, grid)
+						!= ss->old[grid.y][grid.x]) {
+					scent_mismatch++;
+				}
+				for (i = 0; i < (int) N_ELEMENTS(smells); ++i) {
+					struct loc t1 = loc(0, 0), t2 = loc(0, 0);
+					bool f1 = scent_target(ss, true, smells[i],
+						grid, &t1);
+					bool f2 = scent_target(ss, false, smells[i],
+						grid, &t2);
+
+					if (f1 != f2 || !loc_eq(t1, t2)) {
+						track_mismatch++;
+					}
+				}
+			}
+		}
+	}
+	eq(scent_mismatch, 0);
+	eq(track_mismatch, 0);
+	ok;
+}
+
+const char *suite_name = "cave/scent";
+struct test tests[] = {
+	{ "tracking", test_tracking },
+	{ NULL, NULL }
+};
@@ -1,3 +1,6 @@
 TESTPROGS += \
 	cave/find \
-	cave/scatter
+	cave/los \
+	cave/noise \
+	cave/scatter \
+	cave/scent
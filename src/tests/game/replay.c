@@ -0,0 +1,204 @@
+/* game/replay.c */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+
+#include <stdio.h>
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-event.h"
+#include "game-input.h"
+#include "game-record.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "obj-gear.h"
+#include "player.h"
+#include "player-birth.h"
+#include "z-file.h"
+#include "z-rand.h"
+#include "z-util.h"
+
+/* The hash of the state the recorded game ended in */
+static uint32_t recorded_hash;
+
+static void println(const char *str) {
+	printf("%s\n", str);
+}
+
+static void reset_game(void) {
+	play_again = true;
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	chunk_list_max = 0;
+	init_angband();
+	play_again = false;
+}
+
+/* Stand in for the frontend, which is asked how many to drop */
+static int answer_quantity(const char *prompt, int max) {
+	return 1;
+}
+
+/* Pick a way to walk which isn't into a wall */
+static int walk_direction(void) {
+	int tries;
+
+	for (tries = 0; tries < 20; tries++) {
+		int dir = ddd[randint0(8)];
+
+		if (square_ispassable(cave, loc_sum(player->grid, ddgrid[dir])))
+			return dir;
+	}
+	return 5;
+}
+
+/* Something the character carries more than one of, to drop one */
+static struct object *droppable(void) {
+	struct object *obj;
+
+	for (obj = player->gear; obj; obj = obj->next) {
+		if (obj->number > 1 && !object_is_equipped(player->body, obj))
+			return obj;
+	}
+	return NULL;
+}
+
+int setup_tests(void **state) {
+	/* Register a basic error handler */
+	plog_aux = println;
+
+	/* Init the game */
+	set_file_paths();
+	init_angband();
+#ifdef UNIX
+	/* Necessary for creating the randart file. */
+	create_needed_dirs();
+#endif
+
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	file_delete("Test-replay");
+	file_delete("Test-replay-changed");
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	get_quantity_hook = NULL;
+	return 0;
+}
+
+static int test_record(void *state) {
+	int i;
+
+	get_quantity_hook = answer_quantity;
+
+	/*
+	 * Play the same game every time; in some the character starts where
+	 * it can't walk anywhere, which leaves nothing to turn around
+	 */
+	Rand_state_init(1);
+	eq(record_start("Test-replay"), true);
+
+	/* Make a character and take them into the dungeon */
+	eq(player_make_simple(NULL, NULL, "Tester"), true);
+	prepare_next_level(player);
+	on_new_level();
+	cmdq_push(CMD_GO_DOWN);
+	run_game_loop();
+	eq(player->depth, 1);
+
+	/* Wander about, dropping things now and then */
+	for (i = 0; i < 100 && !player->is_dead; i++) {
+		struct object *obj = droppable();
+
+		if (i % 25 == 10 && obj) {
+			cmdq_push(CMD_DROP);
+			cmd_set_arg_item(cmdq_peek(), "item", obj);
+		} else {
+			cmdq_push(CMD_WALK);
+			cmd_set_arg_direction(cmdq_peek(), "direction",
+				walk_direction());
+		}
+		run_game_loop();
+	}
+
+	/* Quit, as the frontend would; it stops by itself on a death */
+	if (!player->is_dead) {
+		player->upkeep->playing = false;
+		run_game_loop();
+	}
+	record_stop();
+	recorded_hash = game_state_hash();
+	get_quantity_hook = NULL;
+	ok;
+}
+
+static int test_replay(void *state) {
+	uint32_t hash;
+	bool same;
+
+	reset_game();
+	same = replay_game("Test-replay", &hash);
+	eq(same, true);
+	eq(hash, recorded_hash);
+	eq(player->depth, 1);
+	ok;
+}
+
+static int test_replay_changed(void *state) {
+	char buf[1024];
+	ang_file *in, *out;
+	uint32_t hash;
+	int walks = 0, turn_at;
+	bool turned = false, same;
+
+	/* Count the walks, to turn the character around halfway through */
+	in = file_open("Test-replay", MODE_READ, FTYPE_TEXT);
+	notnull(in);
+	while (file_getl(in, buf, sizeof(buf))) {
+		if (prefix(buf, "arg direction direction ")) walks++;
+	}
+	file_close(in);
+	turn_at = walks / 2;
+	walks = 0;
+
+	/* Copy the record, turning the character around on one of the walks */
+	in = file_open("Test-replay", MODE_READ, FTYPE_TEXT);
+	notnull(in);
+	out = file_open("Test-replay-changed", MODE_WRITE, FTYPE_TEXT);
+	notnull(out);
+	while (file_getl(in, buf, sizeof(buf))) {
+		if (prefix(buf, "arg direction direction ")
+				&& ++walks >= turn_at && !turned) {
+			int dir = atoi(buf + strlen("arg direction direction "));
+
+			/* Standing still is the same either way round */
+			if (dir != 5) {
+				my_strcpy(buf, format("arg direction direction %d",
+					10 - dir), sizeof(buf));
+				turned = true;
+			}
+		}
+		file_putf(out, "%s\n", buf);
+	}
+	file_close(in);
+	file_close(out);
+	require(turned);
+
+	reset_game();
+	same = replay_game("Test-replay-changed", &hash);
+	eq(same, false);
+	require(hash != recorded_hash);
+	ok;
+}
+
+const char *suite_name = "game/replay";
+struct test tests[] = {
+	{ "record", test_record },
+	{ "replay", test_replay },
+	{ "replay-changed", test_replay_changed },
+	{ NULL, NULL }
+};
@@ -0,0 +1,420 @@
+/* game/savefile */
+/* Check that a game comes back from its savefile unchanged */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "player.h"
+#include "player-birth.h"
+#include "player-util.h"
+#include "savefile.h"
+#include "z-file.h"
+#include "z-rand.h"
+
+#define SAVEFILE_TEST_FILE "Test_savefile"
+#define SAVEFILE_TEST_RESAVE "Test_savefile2"
+#define SAVEFILE_TEST_BACKGROUND "Test_savefile3"
+#define SAVEFILE_TEST_UNWRITABLE "No_such_directory/Test_savefile"
+
+/* Sizes of the file header and of each block header */
+#define SAVEFILE_TEST_HEAD 8
+#define SAVEFILE_TEST_BLOCK_HEAD 28
+
+/*
+ * Blocks which should come back byte for byte after loading and saving.
+ * The monster list is left out since loading reverses the order of the
+ * objects each monster carries; the snapshot checks the monsters instead.
+ */
+static const char *stable_blocks[] = {
+	"monster memory", "object memory", "artifacts", "gear", "dungeon",
+	"objects", "traps", "chunks"
+};
+
+/**
+ * What is remembered about the level before saving it
+ */
+struct level_snapshot {
+	int height, width;
+	uint8_t *feat;
+	bitflag *info;
+	int objects;
+	int monsters;
+	uint32_t monster_hash;
+};
+
+int setup_tests(void **state) {
+	set_file_paths();
+	init_angband();
+#ifdef UNIX
+	/* Necessary for creating the randart file. */
+	create_needed_dirs();
+#endif
+
+	/* Make a character on a level with monsters and objects */
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	Rand_state_init(7);
+	dungeon_change_level(player, 15);
+	prepare_next_level(player);
+	player->upkeep->generate_level = false;
+	on_new_level();
+
+	*state = mem_zalloc(sizeof(struct level_snapshot));
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	struct level_snapshot *snap = state;
+
+	mem_free(snap->info);
+	mem_free(snap->feat);
+	mem_free(snap);
+	file_delete(SAVEFILE_TEST_FILE);
+	file_delete(SAVEFILE_TEST_RESAVE);
+	file_delete(SAVEFILE_TEST_BACKGROUND);
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+static void reset_before_load(void) {
+	play_again = true;
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	chunk_list_max = 0;
+	init_angband();
+	play_again = false;
+}
+
+static void take_snapshot(struct chunk *c, struct level_snapshot *snap) {
+	struct loc grid;
+	int i, j = 0;
+
+	snap->height = c->height;
+	snap->width = c->width;
+	snap->feat = mem_zalloc(c->height * c->width);
+	snap->info = mem_zalloc(c->height * c->width * SQUARE_SIZE);
+	snap->objects = 0;
+	for (grid.y = 0; grid.y < c->height; grid.y++) {
+		for (grid.x = 0; grid.x < c->width; grid.x++) {
+			struct object *obj;
+
+			snap->feat[j] = square(c, grid)->feat;
+			memcpy(snap->info + j * SQUARE_SIZE, square(c, grid)->info,
+				SQUARE_SIZE);
+			for (obj = square_object(c, grid); obj; obj = obj->next) {
+				snap->objects++;
+			}
+			j++;
+		}
+	}
+
+	snap->monsters = 0;
+	snap->monster_hash = 0;
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+
+		if (!mon->race) continue;
+		snap->monsters++;
+		snap->monster_hash = snap->monster_hash * 31 + mon->race->ridx;
+		snap->monster_hash = snap->monster_hash * 31 + mon->hp;
+		snap->monster_hash = snap->monster_hash * 31
+			+ (uint32_t) (mon->grid.y * 256 + mon->grid.x);
+	}
+}
+
+/**
+ * Read a whole savefile into memory
+ */
+static uint8_t *read_savefile(const char *path, size_t *len) {
+	ang_file *f = file_open(path, MODE_READ, FTYPE_SAVE);
+	size_t size = 4096;
+	uint8_t *data;
+	int n;
+
+	*len = 0;
+	if (!f) return NULL;
+	data = mem_alloc(size);
+	while ((n = file_read(f, (char *) data + *len, size - *len)) > 0) {
+		*len += n;
+		if (*len == size) {
+			size *= 2;
+			data = mem_realloc(data, size);
+		}
+	}
+	file_close(f);
+	return data;
+}
+
+/**
+ * Find a named block, returning its header and contents as one span
+ */
+static const uint8_t *find_block(const uint8_t *data, size_t len,
+		const char *name, size_t *block_len) {
+	size_t pos = SAVEFILE_TEST_HEAD;
+
+	while (pos + SAVEFILE_TEST_BLOCK_HEAD <= len) {
+		const uint8_t *head = data + pos;
+		size_t size = head[20] | (head[21] << 8) | (head[22] << 16)
+			| ((size_t) head[23] << 24);
+
+		if (!head[0]) break;
+		if (strncmp((const char *) head, name, 16) == 0) {
+			*block_len = MIN(SAVEFILE_TEST_BLOCK_HEAD + size, len - pos);
+			return head;
+		}
+
+		/* Blocks are padded to a multiple of 4 bytes */
+		pos += SAVEFILE_TEST_BLOCK_HEAD + size;
+		if (size % 4) pos += 4 - (size % 4);
+	}
+	return NULL;
+}
+
+/**
+ * Check whether two savefiles have the same bytes for the named block
+ */
+static bool same_block(const char *path1, const char *path2,
+		const char *name) {
+	size_t len1, len2, block_len1 = 0, block_len2 = 0;
+	uint8_t *data1 = read_savefile(path1, &len1);
+	uint8_t *data2 = read_savefile(path2, &len2);
+	const uint8_t *block1 = data1 ?
+		find_block(data1, len1, name, &block_len1) : NULL;
+	const uint8_t *block2 = data2 ?
+		find_block(data2, len2, name, &block_len2) : NULL;
+	bool same = block1 && block2 && block_len1 == block_len2
+		&& memcmp(block1, block2, block_len1) == 0;
+
+	mem_free(data2);
+	mem_free(data1);
+	return same;
+}
+
+static int test_round_trip(void *state) {
+	struct level_snapshot *snap = state;
+	struct level_snapshot *loaded = mem_zalloc(sizeof(*loaded));
+	int32_t old_turn = turn;
+	int32_t old_exp = player->exp;
+	int32_t old_au = player->au;
+	bool same;
+	int i;
+
+	take_snapshot(cave, snap);
+	require(snap->monsters > 0);
+	require(snap->objects > 0);
+	eq(savefile_save(SAVEFILE_TEST_FILE), true);
+
+	reset_before_load();
+	eq(savefile_load(SAVEFILE_TEST_FILE, false), true);
+	notnull(cave);
+	eq(turn, old_turn);
+	eq(player->exp, old_exp);
+	eq(player->au, old_au);
+	eq(player->depth, 15);
+
+	/* The level itself */
+	take_snapshot(cave, loaded);
+	same = loaded->height == snap->height && loaded->width == snap->width
+		&& memcmp(loaded->feat, snap->feat,
+			snap->height * snap->width) == 0
+		&& memcmp(loaded->info, snap->info,
+			snap->height * snap->width * SQUARE_SIZE) == 0
+		&& loaded->objects == snap->objects
+		&& loaded->monsters == snap->monsters
+		&& loaded->monster_hash == snap->monster_hash;
+	mem_free(loaded->info);
+	mem_free(loaded->feat);
+	mem_free(loaded);
+	require(same);
+
+	/*
+	 * Saving again writes the same bytes for everything but the parts
+	 * which loading itself changes, such as the RNG state
+	 */
+	eq(savefile_save(SAVEFILE_TEST_RESAVE), true);
+	for (i = 0; same && i < (int) N_ELEMENTS(stable_blocks); i++) {
+		if (!same_block(SAVEFILE_TEST_FILE, SAVEFILE_TEST_RESAVE,
+				stable_blocks[i])) {
+			if (verbose) printf("%s differs  ", stable_blocks[i]);
+			same = false;
+		}
+	}
+	require(same);
+	ok;
+}
+
+static int test_background(void *state) {
+	uint8_t *background, *foreground;
+	size_t background_len, foreground_len;
+	bool same;
+
+	/* The second has to wait for the first to finish with the file */
+	savefile_save_background(SAVEFILE_TEST_BACKGROUND);
+	savefile_save_background(SAVEFILE_TEST_BACKGROUND);
+	eq(savefile_flush(), true);
+	eq(character_saved, true);
+	eq(file_exists(SAVEFILE_TEST_BACKGROUND), true);
+
+	/* One that can't be written is reported, and doesn't count as saved */
+	savefile_save_background(SAVEFILE_TEST_UNWRITABLE);
+	eq(savefile_flush(), false);
+	eq(character_saved, false);
+
+	/* Nothing has changed, so a save in the foreground is the same */
+	eq(savefile_save(SAVEFILE_TEST_RESAVE), true);
+	background = read_savefile(SAVEFILE_TEST_BACKGROUND, &background_len);
+	foreground = read_savefile(SAVEFILE_TEST_RESAVE, &foreground_len);
+	same = background && foreground && background_len == foreground_len
+		&& memcmp(background, foreground, background_len) == 0;
+	mem_free(foreground);
+	mem_free(background);
+	require(same);
+
+	reset_before_load();
+	eq(savefile_load(SAVEFILE_TEST_BACKGROUND, false), true);
+	eq(player->depth, 15);
+	ok;
+}
+
+static int test_stored_levels(void *state) {
+	struct chunk *stored = chunk_write(cave);
+	struct chunk *loaded;
+	struct loc grid = loc(1, 1);
+
+	stored->name = string_make("Test level");
+	stored->depth = 14;
+	chunk_list_add(stored);
+
+	/* The first save encodes the stored level and keeps the bytes */
+	eq(savefile_save(SAVEFILE_TEST_FILE), true);
+	notnull(stored->saved);
+
+	/* Saving from the kept bytes gives the same as encoding it again */
+	eq(savefile_save(SAVEFILE_TEST_RESAVE), true);
+	require(same_block(SAVEFILE_TEST_FILE, SAVEFILE_TEST_RESAVE, "chunks"));
+	cave_unpack(stored);
+	mem_free(stored->saved);
+	stored->saved = NULL;
+	cave_pack(stored);
+	eq(savefile_save(SAVEFILE_TEST_RESAVE), true);
+	require(same_block(SAVEFILE_TEST_FILE, SAVEFILE_TEST_RESAVE, "chunks"));
+
+	/* Taking it off the list to change it means it is encoded afresh */
+	require(chunk_list_remove("Test level"));
+	null(stored->saved);
+	square_set_feat(stored, grid, FEAT_RUBBLE);
+	chunk_list_add(stored);
+	eq(savefile_save(SAVEFILE_TEST_RESAVE), true);
+	require(!same_block(SAVEFILE_TEST_FILE, SAVEFILE_TEST_RESAVE, "chunks"));
+
+	reset_before_load();
+	eq(savefile_load(SAVEFILE_TEST_RESAVE, false), true);
+	loaded = chunk_find_name("Test level");
+	notnull(loaded);
+	notnull(loaded->packed);
+	cave_unpack(loaded);
+	eq(square(loaded, grid)->feat, FEAT_RUBBLE);
+	ok;
+}
+
+/**
+ * Reduce the light and heatmaps of a level to a single number
+ */
+static uint32_t hash_grids(struct chunk *c) {
+	uint32_t hash = 0;
+	int i;
+
+	for (i = 0; i < c->height * c->width; i++) {
+		hash = hash * 31 + (uint32_t) c->squares[0][i].light;
+		hash = hash * 31 + c->noise.grids[0][i];
+		hash = hash * 31 + c->scent.grids[0][i];
+	}
+	return hash;
+}
+
+static int test_packed_levels(void *state) {
+	struct level_snapshot *before = mem_zalloc(sizeof(*before));
+	struct level_snapshot *after = mem_zalloc(sizeof(*after));
+	struct chunk *stored[3];
+	struct monster *mon[3];
+	uint32_t grids_hash;
+	int noisy = 0;
+	bool same;
+	int i;
+
+	/* Packing and unpacking a level gives back everything on it */
+	take_snapshot(cave, before);
+	require(before->monsters > 0);
+	require(before->objects > 0);
+	cave->noise.grids[2][3] = 5;
+	cave->scent.grids[4][5] = 6;
+	grids_hash = hash_grids(cave);
+	for (i = 0; i < cave->height * cave->width; i++) {
+		if (cave->noise.grids[0][i]) noisy++;
+	}
+	cave_pack(cave);
+	notnull(cave->packed);
+	null(cave->squares);
+	cave_unpack(cave);
+	null(cave->packed);
+	take_snapshot(cave, after);
+	same = after->height == before->height && after->width == before->width
+		&& memcmp(after->feat, before->feat,
+			before->height * before->width) == 0
+		&& memcmp(after->info, before->info,
+			before->height * before->width * SQUARE_SIZE) == 0
+		&& after->objects == before->objects
+		&& after->monsters == before->monsters
+		&& after->monster_hash == before->monster_hash
+		&& hash_grids(cave) == grids_hash;
+	mem_free(after->info);
+	mem_free(after->feat);
+	mem_free(after);
+	mem_free(before->info);
+	mem_free(before->feat);
+	mem_free(before);
+	require(same);
+
+	/* The noise can still be cleared away as the player moves */
+	eq(cave->noise_count, noisy);
+	cave->noise.grids[2][3] = 0;
+	cave->scent.grids[4][5] = 0;
+
+	/* Stored levels are found by name, before and after others go */
+	for (i = 0; i < 3; i++) {
+		stored[i] = chunk_write(cave);
+		stored[i]->name = string_make(format("Packed level %d", i));
+		mon[i] = cave_monster(stored[i], 1);
+		chunk_list_add(stored[i]);
+		notnull(stored[i]->packed);
+	}
+	ptreq(chunk_find_name("Packed level 1"), stored[1]);
+	require(chunk_list_remove("Packed level 0"));
+	null(stored[0]->packed);
+
+	/* Anything still pointing at their monsters stays good */
+	for (i = 0; i < 3; i++) {
+		ptreq(cave_monster(stored[i], 1), mon[i]);
+	}
+	null(chunk_find_name("Packed level 0"));
+	ptreq(chunk_find_name("Packed level 2"), stored[2]);
+	ptreq(chunk_find_name("Packed level 1"), stored[1]);
+	cave_free(stored[0]);
+	ok;
+}
+
+const char *suite_name = "game/savefile";
+struct test tests[] = {
+	{ "round_trip", test_round_trip },
+	{ "background", test_background },
+	{ "stored_levels", test_stored_levels },
+	{ "packed_levels", test_packed_levels },
+	{ NULL, NULL }
+};
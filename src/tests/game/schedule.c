@@ -0,0 +1,142 @@
+/* game/schedule */
+/* Check that scheduling monster turns changes nothing about the game */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "mon-move.h"
+#include "player.h"
+#include "player-birth.h"
+#include "player-timed.h"
+#include "player-util.h"
+#include "savefile.h"
+#include "z-rand.h"
+
+#define SCHEDULE_TEST_FILE "Test_schedule"
+#define SCHEDULE_TEST_HOLDS 400
+
+int setup_tests(void **state) {
+	set_file_paths();
+	init_angband();
+#ifdef UNIX
+	/* Necessary for creating the randart file. */
+	create_needed_dirs();
+#endif
+
+	/* Make a character on a level with a fair number of monsters */
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	Rand_state_init(1);
+	dungeon_change_level(player, 25);
+	prepare_next_level(player);
+	player->upkeep->generate_level = false;
+	on_new_level();
+	if (!savefile_save(SCHEDULE_TEST_FILE)) {
+		cleanup_angband();
+		return 1;
+	}
+
+	*state = mem_zalloc(SCHEDULE_TEST_HOLDS * sizeof(uint32_t));
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	mem_free(state);
+	file_delete(SCHEDULE_TEST_FILE);
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+static void reset_before_load(void) {
+	play_again = true;
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	chunk_list_max = 0;
+	init_angband();
+	play_again = false;
+}
+
+/**
+ * Reduce the state of the game to a single number for comparison
+ */
+static uint32_t hash_game(void)
+{
+	uint32_t hash = (uint32_t) turn;
+	int i;
+
+	hash = hash * 31 + (uint32_t) player->chp;
+	hash = hash * 31 + (uint32_t) player->depth;
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		struct monster *mon = cave_monster(cave, i);
+
+		if (!mon->race) continue;
+		sync_monster_energy(cave, mon);
+		hash = hash * 31 + (uint32_t) i;
+		hash = hash * 31 + (uint32_t) mon->race->ridx;
+		hash = hash * 31 + (uint32_t) (mon->grid.y * 256 + mon->grid.x);
+		hash = hash * 31 + (uint32_t) mon->hp;
+		hash = hash * 31 + (uint32_t) mon->energy;
+		hash = hash * 31 + (uint32_t) mon->m_timed[MON_TMD_SLEEP];
+	}
+	return hash;
+}
+
+/**
+ * Load the saved game and have the character stand still for a while,
+ * recording the state of the game after each turn
+ */
+static bool play_held(uint32_t *hashes, bool scheduled)
+{
+	int i;
+
+	reset_before_load();
+	if (!savefile_load(SCHEDULE_TEST_FILE, false)) return false;
+	on_new_level();
+	if (!scheduled) free_monster_schedule(cave);
+
+	/* Keep the character alive and the dice the same */
+	(void) player_inc_timed(player, TMD_INVULN, 10000, false, false, false);
+	Rand_state_init(2);
+
+	for (i = 0; i < SCHEDULE_TEST_HOLDS; i++) {
+		if (!player->is_dead && !player->upkeep->generate_level) {
+			cmdq_push(CMD_HOLD);
+			run_game_loop();
+		}
+		hashes[i] = hash_game();
+	}
+	hashes[0] = hashes[0] * 31 + Rand_div(0x10000);
+	return true;
+}
+
+static int test_same_game(void *state) {
+	uint32_t *scheduled = state;
+	uint32_t *unscheduled = mem_zalloc(SCHEDULE_TEST_HOLDS * sizeof(uint32_t));
+	int i, mismatches = 0;
+
+	require(play_held(scheduled, true));
+	require(cave->schedule != NULL);
+	require(cave_monster_count(cave) > 0);
+	require(play_held(unscheduled, false));
+	require(cave->schedule == NULL);
+	for (i = 0; i < SCHEDULE_TEST_HOLDS; i++) {
+		if (scheduled[i] != unscheduled[i]) mismatches++;
+	}
+	mem_free(unscheduled);
+	eq(mismatches, 0);
+	ok;
+}
+
+const char *suite_name = "game/schedule";
+struct test tests[] = {
+	{ "same_game", test_same_game },
+	{ NULL, NULL }
+};
@@ -1,2 +1,5 @@
 TESTPROGS += game/basic \
-	game/mage
+	game/mage \
+	game/replay \
+	game/savefile \
+	game/schedule
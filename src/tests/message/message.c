@@ -254,6 +254,51 @@ static int test_fill(void *state) {
 	ok;
 }
 
+/**
+ * Text for the ith message in test_wrap(), with a length that keeps changing
+ */
+static void wrap_text(char *buf, size_t len, int i) {
+	strnfmt(buf, len, "%.*s%d", i % 37,
+		"abcdefghijklmnopqrstuvwxyzabcdefghijk", i);
+}
+
+static int test_wrap(void *state) {
+	char buf[64];
+	uint16_t n = 0, j;
+	int i, total;
+
+	messages_free();
+	messages_init();
+
+	/* Find how many it holds */
+	for (i = 0; n == i; i++) {
+		wrap_text(buf, sizeof(buf), i);
+		message_add(buf, (uint16_t) (i % MSG_MAX));
+		n = messages_num();
+	}
+
+	/* Go round the buffer a few more times */
+	total = i + 3 * (int) n + 5;
+	for (; i < total; i++) {
+		wrap_text(buf, sizeof(buf), i);
+		message_add(buf, (uint16_t) (i % MSG_MAX));
+	}
+	eq(messages_num(), n);
+
+	/* Every age still gives its own message */
+	for (j = 0; j < n; j++) {
+		i = total - 1 - (int) j;
+		wrap_text(buf, sizeof(buf), i);
+		require(streq(message_str(j), buf));
+		eq(message_type(j), i % MSG_MAX);
+		eq(message_count(j), 1);
+	}
+	require(streq(message_str(n), ""));
+	eq(message_count(n), 0);
+
+	ok;
+}
+
 static int test_many_repeat(void *state)
 {
 	int i = 0;
@@ -662,6 +707,7 @@ struct test tests[] = {
 	{ "empty", test_empty },
 	{ "add", test_add },
 	{ "fill", test_fill },
+	{ "wrap", test_wrap },
 	{ "many_repeat", test_many_repeat },
 	{ "color", test_color },
 	{ "format", test_msg },
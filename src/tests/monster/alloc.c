@@ -0,0 +1,346 @@
+/* monster/alloc */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+
+#include "init.h"
+#include "monster.h"
+#include "mon-make.h"
+#include <math.h>
+
+#define NUM_TEST_RACES 11
+
+struct alloc_test_state {
+	int *histogram;
+	double *expected;
+};
+
+extern struct init_module mon_make_module;
+
+/* Level, rarity, whether unique and whether forced to depth for each race */
+static const struct {
+	int level, rarity;
+	bool unique, force_depth;
+} test_races[NUM_TEST_RACES] = {
+	{ 0, 0, false, false },	/* Unused */
+	{ 0, 1, false, false },
+	{ 0, 2, false, false },
+	{ 1, 1, false, false },
+	{ 2, 2, false, false },
+	{ 3, 1, true, false },
+	{ 4, 4, false, false },
+	{ 5, 1, false, true },
+	{ 10, 1, false, false },
+	{ 12, 1, true, false },
+	{ 0, 0, false, false },	/* The ghost */
+};
+
+int setup_tests(void **state) {
+	struct alloc_test_state *st;
+	int i;
+
+	player = &test_player;
+
+	z_info = mem_zalloc(sizeof(*z_info));
+	z_info->r_max = NUM_TEST_RACES;
+	z_info->max_depth = 20;
+	z_info->ood_monster_chance = 25;
+	z_info->ood_monster_amount = 10;
+
+	/*
+	 * Set up a small number of fake races with a mix of the attributes
+	 * get_mon_num() uses.
+	 */
+	r_info = mem_zalloc(sizeof(*r_info) * z_info->r_max);
+	for (i = 0; i < z_info->r_max; ++i) {
+		r_info[i].ridx = i;
+		r_info[i].level = test_races[i].level;
+		r_info[i].rarity = test_races[i].rarity;
+		r_info[i].max_num = 1;
+		if (test_races[i].unique) {
+			rf_on(r_info[i].flags, RF_UNIQUE);
+		}
+		if (test_races[i].force_depth) {
+			rf_on(r_info[i].flags, RF_FORCE_DEPTH);
+		}
+	}
+
+	/* The deeper unique is already around */
+	r_info[9].cur_num = 1;
+
+	st = mem_alloc(sizeof(*st));
+	st->histogram = mem_alloc(z_info->r_max * sizeof(*st->histogram));
+	st->expected = mem_alloc(z_info->r_max * sizeof(*st->expected));
+	*state = st;
+
+	(*mon_make_module.init)();
+
+	return 0;
+}
+
+
+int teardown_tests(void *state) {
+	struct alloc_test_state *st = state;
+
+	(*mon_make_module.cleanup)();
+	if (st) {
+		mem_free(st->expected);
+		mem_free(st->histogram);
+		mem_free(st);
+	}
+	mem_free(r_info);
+	mem_free(z_info);
+	return 0;
+}
+
+
+/*
+ * Compute the G-test statistic, https://en.wikipedia.org/wiki/G-test , given
+ * the number of observed occurences, obs, in n different categories with
+ * ntotal observations made and the expected probability, ex, of each of those
+ * categories.  The distribution for the result is expected to be approximately
+ * a chi-squared distribution with the degrees of freedom equal to one less
+ * than the number of nonzero elements in ex.
+ */
+static double compute_gtest_statistic(const int *ob, const double *ex,
+	int n, int ntotal)
+{
+	double result = 0.0;
+	int i;
+
+	for (i = 0; i < n; ++i) {
+		double oprob;
+
+		/* Zero observations don't contribute. */
+		if (!ob[i]) continue;
+
+		/*
+		 * There were nonzero observations in a supposedly impossible
+		 * category.
+		 */
+		if (ex[i] == 0.0) return 1e30;
+
+		oprob = ob[i] / (double) ntotal;
+		result += ob[i] * log(oprob / ex[i]);
+	}
+
+	return 2.0 * result;
+}
+
+
+/*
+ * Returns true if the chance of drawing a value greater than or equal to v
+ * from a chi-squared distribution with ndof degrees of freedom is less than
+ * .1%
+ */
+static bool satisfies_chisq_criteria(double v, int ndof)
+{
+	const double table[] = {
+		10.82757, 13.81551, 16.26624, 18.46683, 20.51501,
+		22.45774, 24.32189, 26.12448
+	};
+
+	if (ndof <= 0 || ndof > (int)N_ELEMENTS(table)) {
+		return false;
+	}
+	return v < table[ndof - 1];
+}
+
+
+static bool hook_not_8(struct monster_race *race)
+{
+	return race != &r_info[8];
+}
+
+
+static bool hook_3_or_9(struct monster_race *race)
+{
+	return race == &r_info[3] || race == &r_info[9];
+}
+
+
+/*
+ * The deeper of two races, preferring the second, as get_mon_num() keeps
+ * when trying for a harder monster
+ */
+static int deeper(int i, int j)
+{
+	return (r_info[j].level < r_info[i].level) ? i : j;
+}
+
+
+/*
+ * Work out the chance of each race from get_mon_num() the long way, the way
+ * it used to do it
+ */
+static void compute_mon_num_expected(int level, int current,
+	bool (*hook)(struct monster_race *race), double *ex, int *nnonzero)
+{
+	double pboost = (level > 0) ? 1.0 / z_info->ood_monster_chance : 0.0;
+	int i;
+
+	for (i = 0; i < z_info->r_max; ++i) {
+		ex[i] = 0.0;
+	}
+
+	for (i = 1; i >= 0; --i) {
+		double q[NUM_TEST_RACES], mult;
+		int total = 0, boosted_level, j, k, m;
+
+		if (i == 0) {
+			mult = 1.0 - pboost;
+			boosted_level = level;
+		} else {
+			mult = pboost;
+			boosted_level = level + MIN(level / 4 + 2,
+				z_info->ood_monster_amount);
+		}
+		if (mult == 0.0) continue;
+
+		for (j = 0; j < z_info->r_max; ++j) {
+			const struct monster_race *race = &r_info[j];
+			int p = 0;
+
+			if (j > 0 && j < z_info->r_max - 1 && race->rarity
+					&& race->level <= boosted_level
+					&& (boosted_level == 0 || race->level > 0)
+					&& (!hook || hook(&r_info[j]))
+					&& !(rf_has(race->flags, RF_UNIQUE)
+					&& race->cur_num >= race->max_num)
+					&& !(rf_has(race->flags, RF_FORCE_DEPTH)
+					&& race->level > current)) {
+				p = (100 / race->rarity) * (1 + race->level / 10);
+			}
+			q[j] = p;
+			total += p;
+		}
+		if (!total) continue;
+		for (j = 0; j < z_info->r_max; ++j) {
+			q[j] /= total;
+		}
+
+		/* One draw (40%), the deeper of two (50%) or of three (10%) */
+		for (j = 0; j < z_info->r_max; ++j) {
+			ex[j] += mult * 0.4 * q[j];
+			for (k = 0; k < z_info->r_max; ++k) {
+				double pjk = q[j] * q[k];
+
+				if (pjk == 0.0) continue;
+				ex[deeper(j, k)] += mult * 0.5 * pjk;
+				for (m = 0; m < z_info->r_max; ++m) {
+					ex[deeper(deeper(j, k), m)] +=
+						mult * 0.1 * pjk * q[m];
+				}
+			}
+		}
+	}
+
+	*nnonzero = 0;
+	for (i = 0; i < z_info->r_max; ++i) {
+		if (ex[i] > 0.0) {
+			++*nnonzero;
+		}
+	}
+}
+
+
+/*
+ * There is a non-deterministic element to this test.  The threshold for
+ * failure is unlikely to be met (expected to be .1% for each of the cases
+ * below) but can happen even if get_mon_num() performs correctly.
+ */
+static int test_get_mon_num_basic(void *state) {
+	struct {
+		int level, current;
+		bool (*hook)(struct monster_race *race);
+	} cases[] = {
+		{ 0, 0, NULL },
+		{ 1, 1, NULL },
+		{ 3, 3, NULL },
+		{ 5, 5, NULL },
+		{ 5, 3, NULL },
+		{ 12, 12, NULL },
+		{ 12, 12, hook_not_8 },
+		{ 12, 12, hook_3_or_9 },
+		{ 30, 30, NULL },
+	};
+	int ntrials = 30000, i;
+	struct alloc_test_state *st = state;
+
+	for (i = 0; i < (int)N_ELEMENTS(cases); ++i) {
+		int j, nnonzero;
+
+		get_mon_num_prep(cases[i].hook);
+		for (j = 0; j < z_info->r_max; ++j) {
+			st->histogram[j] = 0;
+		}
+		for (j = 0; j < ntrials; ++j) {
+			const struct monster_race *race =
+				get_mon_num(cases[i].level, cases[i].current);
+
+			/*
+			 * The tests have been configured so a race should
+			 * always be found.
+			 */
+			notnull(race);
+			require(race > r_info && race < r_info + z_info->r_max - 1);
+			if (cases[i].hook) {
+				require(cases[i].hook((struct monster_race *) race));
+			}
+			++st->histogram[race - r_info];
+		}
+
+		compute_mon_num_expected(cases[i].level, cases[i].current,
+			cases[i].hook, st->expected, &nnonzero);
+		require(nnonzero >= 1);
+		if (nnonzero == 1) {
+			int k;
+
+			for (k = 0; k < z_info->r_max; ++k) {
+				if (st->expected[k] > 0.0) {
+					eq(st->histogram[k], ntrials);
+				}
+			}
+		} else {
+			double gtest = compute_gtest_statistic(st->histogram,
+				st->expected, z_info->r_max, ntrials);
+
+			require(satisfies_chisq_criteria(gtest, nnonzero - 1));
+		}
+	}
+	get_mon_num_prep(NULL);
+
+	ok;
+}
+
+
+static bool hook_only_5(struct monster_race *race)
+{
+	return race == &r_info[5];
+}
+
+
+static int test_get_mon_num_none(void *state) {
+	/* The only race allowed is a unique that's already around */
+	r_info[5].cur_num = 1;
+	get_mon_num_prep(hook_only_5);
+	null(get_mon_num(3, 3));
+	r_info[5].cur_num = 0;
+	notnull(get_mon_num(3, 3));
+	get_mon_num_prep(NULL);
+
+	/* There's nothing shallow enough */
+	get_mon_num_prep(hook_only_5);
+	null(get_mon_num(0, 0));
+	get_mon_num_prep(NULL);
+
+	ok;
+}
+
+
+const char *suite_name = "monster/alloc";
+struct test tests[] = {
+	{ "get_mon_num_basic", test_get_mon_num_basic },
+	{ "get_mon_num_none", test_get_mon_num_none },
+	{ NULL, NULL }
+};
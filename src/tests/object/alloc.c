@@ -110,7 +110,7 @@ static double compute_gtest_statistic(const int *ob, const double *ex,
 		if (ex[i] == 0.0) return 1e30;
 
 		oprob = ob[i] / (double) ntotal;
-		result += oprob * log(oprob / ex[i]);
+		result += ob[i] * log(oprob / ex[i]);
 	}
 
 	return 2.0 * result;
@@ -152,7 +152,7 @@ static int histogram_max(const int* histogram, int nbin)
 static void compute_obj_num_expected(int level, bool good, int tval,
 	double *ex, int *nnonzero)
 {
-	double pboost = 1.0 / z_info->great_obj;
+	double pboost = (level > 0) ? 1.0 / z_info->great_obj : 0.0;
 	int i;
 
 	for (i = 0; i < z_info->k_max; ++i) {
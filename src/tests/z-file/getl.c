@@ -0,0 +1,139 @@
+/* z-file/getl.c */
+/* Check reading through the file read buffer */
+
+#include "unit-test.h"
+#include "z-file.h"
+#include "z-form.h"
+#include "z-util.h"
+#include "z-virt.h"
+
+#define GETL_TEST_FILE "z-file-getl.tmp"
+
+/* Size of a file which spans a few read buffers */
+#define GETL_TEST_BYTES 10000
+
+NOSETUP
+
+int teardown_tests(void *state) {
+	file_delete(GETL_TEST_FILE);
+	return 0;
+}
+
+static bool write_test_file(const char *contents, size_t n) {
+	ang_file *f = file_open(GETL_TEST_FILE, MODE_WRITE, FTYPE_TEXT);
+	bool written;
+
+	if (!f) return false;
+	written = file_write(f, contents, n);
+	return file_close(f) && written;
+}
+
+static int test_line_endings(void *state) {
+	char *contents = mem_zalloc(GETL_TEST_BYTES);
+	char *line = mem_zalloc(GETL_TEST_BYTES);
+	ang_file *f;
+	size_t n;
+
+	/* Put a \r\n across the end of the first read buffer */
+	memset(contents, 'a', 4095);
+	n = 4095;
+	n += strnfmt(contents + n, GETL_TEST_BYTES - n,
+		"\r\nb\rc\n\tx\r\r\ny\n\nend");
+	require(write_test_file(contents, n));
+
+	f = file_open(GETL_TEST_FILE, MODE_READ, FTYPE_TEXT);
+	notnull(f);
+	require(file_getl(f, line, GETL_TEST_BYTES));
+	eq(strlen(line), 4095);
+	require(file_getl(f, line, GETL_TEST_BYTES));
+	require(streq(line, "b"));
+	require(file_getl(f, line, GETL_TEST_BYTES));
+	require(streq(line, "c"));
+	require(file_getl(f, line, GETL_TEST_BYTES));
+	require(streq(line, "    x"));
+	require(file_getl(f, line, GETL_TEST_BYTES));
+	require(streq(line, "y"));
+	require(file_getl(f, line, GETL_TEST_BYTES));
+	require(streq(line, ""));
+	require(file_getl(f, line, GETL_TEST_BYTES));
+	require(streq(line, "end"));
+	require(!file_getl(f, line, GETL_TEST_BYTES));
+	require(file_close(f));
+
+	mem_free(line);
+	mem_free(contents);
+	ok;
+}
+
+static int test_long_line(void *state) {
+	const char *contents = "abcdefghij\n";
+	char line[4];
+	ang_file *f;
+
+	require(write_test_file(contents, strlen(contents)));
+
+	/* Too long for the buffer, so it comes back in pieces */
+	f = file_open(GETL_TEST_FILE, MODE_READ, FTYPE_TEXT);
+	notnull(f);
+	require(file_getl(f, line, sizeof(line)));
+	require(streq(line, "abc"));
+	require(file_getl(f, line, sizeof(line)));
+	require(streq(line, "def"));
+	require(file_getl(f, line, sizeof(line)));
+	require(streq(line, "ghi"));
+	require(file_getl(f, line, sizeof(line)));
+	require(streq(line, "j"));
+	require(!file_getl(f, line, sizeof(line)));
+	require(file_close(f));
+	ok;
+}
+
+static int test_mixed_reads(void *state) {
+	char *contents = mem_zalloc(GETL_TEST_BYTES);
+	char *got = mem_zalloc(GETL_TEST_BYTES);
+	ang_file *f;
+	uint8_t b;
+	int i;
+
+	for (i = 0; i < GETL_TEST_BYTES; i++) {
+		contents[i] = (char) (i % 251);
+	}
+	require(write_test_file(contents, GETL_TEST_BYTES));
+
+	f = file_open(GETL_TEST_FILE, MODE_READ, FTYPE_SAVE);
+	notnull(f);
+	for (i = 0; i < 10; i++) {
+		require(file_readc(f, &b));
+		eq(b, i % 251);
+	}
+
+	/* Within the buffer, then past it */
+	require(file_skip(f, 100));
+	require(file_readc(f, &b));
+	eq(b, 110 % 251);
+	require(file_skip(f, 5000));
+	require(file_readc(f, &b));
+	eq(b, 5111 % 251);
+
+	/* A read that starts in the buffer and carries on past it */
+	eq(file_read(f, got, 4000), 4000);
+	require(memcmp(got, contents + 5112, 4000) == 0);
+
+	/* Running off the end */
+	eq(file_read(f, got, 4000), GETL_TEST_BYTES - 9112);
+	require(memcmp(got, contents + 9112, GETL_TEST_BYTES - 9112) == 0);
+	require(!file_readc(f, &b));
+	require(file_close(f));
+
+	mem_free(got);
+	mem_free(contents);
+	ok;
+}
+
+const char *suite_name = "z-file/getl";
+struct test tests[] = {
+	{ "line_endings", test_line_endings },
+	{ "long_line", test_long_line },
+	{ "mixed_reads", test_mixed_reads },
+	{ NULL, NULL }
+};
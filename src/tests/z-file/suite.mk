@@ -1,2 +1,3 @@
 TESTPROGS += z-file/filename-index \
+	z-file/getl \
 	z-file/path-normalize
@@ -1,8 +1,13 @@
 /* z-quark/quark.c */
 
 #include "unit-test.h"
+#include "z-form.h"
+#include "z-virt.h"
 #include "z-quark.h"
 
+/* Enough to grow the index several times */
+#define MANY_QUARKS 5000
+
 int setup_tests(void **state) {
 	quarks_init();
 	return 0;
@@ -46,9 +51,39 @@ static int test_dedup(void *state) {
 	ok;
 }
 
+static int test_many(void *state) {
+	quark_t first = quark_add("2-first");
+	quark_t *q = mem_zalloc(MANY_QUARKS * sizeof(*q));
+	char buf[32];
+	int i;
+
+	for (i = 0; i < MANY_QUARKS; i++) {
+		strnfmt(buf, sizeof(buf), "2-@r%d#%d", i % 10, i);
+		q[i] = quark_add(buf);
+		require(q[i]);
+		if (i) require(q[i] == q[i - 1] + 1);
+	}
+
+	/* Every string is still found, as itself, once the index has grown */
+	for (i = 0; i < MANY_QUARKS; i++) {
+		strnfmt(buf, sizeof(buf), "2-@r%d#%d", i % 10, i);
+		require(quark_add(buf) == q[i]);
+		require(streq(quark_str(q[i]), buf));
+	}
+	null(quark_str(q[MANY_QUARKS - 1] + 1));
+
+	/* A string added before the index grew is found too */
+	require(quark_add("2-first") == first);
+	require(streq(quark_str(first), "2-first"));
+
+	mem_free(q);
+	ok;
+}
+
 const char *suite_name = "z-quark/quark";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "dedup", test_dedup },
+	{ "many", test_many },
 	{ NULL, NULL }
 };
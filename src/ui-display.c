@@ -1443,7 +1443,8 @@ static void do_animation(void)
 		if (!mon || !mon->race || !monster_is_visible(mon))
 			continue;
 		else if (rf_has(mon->race->flags, RF_ATTR_MULTI))
-			attr = randint1(BASIC_COLORS - 1);
+			/* Leave the game's random numbers to the game */
+			attr = Rand_simple(BASIC_COLORS - 1) + 1;
 		else if (rf_has(mon->race->flags, RF_ATTR_FLICKER)) {
 			uint8_t base_attr = monster_x_attr[mon->race->ridx];
 
@@ -2542,7 +2543,7 @@ static void new_level_display_update(game_event_type type,
 
 	/* If autosave is pending, do it now. */
 	if (player->upkeep->autosave) {
-		save_game();
+		autosave_game();
 		player->upkeep->autosave = false;
 	}
 
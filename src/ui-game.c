@@ -21,6 +21,7 @@
 #include "cmds.h"
 #include "datafile.h"
 #include "game-input.h"
+#include "game-record.h"
 #include "game-world.h"
 #include "generate.h"
 #include "grafmode.h"
@@ -95,6 +96,11 @@ char savefile[1024];
  */
 char panicfile[1024];
 
+/**
+ * Buffer to hold the name of the file to record the next new game to, if any
+ */
+char recordfile[1024];
+
 /**
  * Set by the front end to perform necessary actions when restarting after death
  * without exiting.  May be NULL.
@@ -294,6 +300,7 @@ struct cmd_info cmd_debug_files[] =
 {
 	{ "Create spoilers", { '"' }, CMD_NULL, do_cmd_spoilers, player_can_debug_prereq, 0, NULL, NULL, NULL, 0 },
 	{ "Write map", { 'M' }, CMD_WIZ_DUMP_LEVEL_MAP, NULL, player_can_debug_prereq, 0, NULL, NULL, NULL, 0 },
+	{ "Write profile", { 'I' }, CMD_WIZ_DUMP_PROFILE, NULL, player_can_debug_prereq, 0, NULL, NULL, NULL, 0 },
 };
 
 struct cmd_info cmd_debug_stats[] =
@@ -622,6 +629,7 @@ void check_for_player_interrupt(game_event_type type, game_event_data *data,
 			/* Flush and disturb */
 			event_signal(EVENT_INPUT_FLUSH);
 			disturb(player);
+			record_interrupt();
 			msg("Cancelled.");
 		}
 	}
@@ -667,6 +675,12 @@ static bool start_game(bool new_game)
 	/* Player will be resuscitated if living in the savefile */
 	player->is_dead = true;
 
+	/* A recorded game starts with a new character, and nothing from before */
+	if (recordfile[0]) {
+		loadpath = "";
+		new_game = true;
+	}
+
 	/* Try loading */
 	savefile_get_panic_name(panicfile, sizeof(panicfile), loadpath);
 	safe_setuid_grab();
@@ -699,6 +713,12 @@ static bool start_game(bool new_game)
 	/* No living character loaded */
 	if (player->is_dead || new_game) {
 		character_generated = false;
+		if (recordfile[0]) {
+			if (!record_start(recordfile)) {
+				quit_fmt("Cannot record the game to %s", recordfile);
+			}
+			recordfile[0] = '\0';
+		}
 		textui_do_birth();
 	} else {
 		/*
@@ -923,7 +943,8 @@ void play_game(enum game_mode_type mode)
 			run_game_loop();
 		}
 
-		/* Close game on death or quitting */
+		/* Finish any record of the game, then close it */
+		record_stop();
 		close_game(true);
 
 		if (!play_again) break;
@@ -996,6 +1017,42 @@ void save_game(void)
 	(void) save_game_checked();
 }
 
+/**
+ * Tell the player if an autosave being written in the background failed
+ */
+static void check_autosave(void)
+{
+	if (!savefile_flush()) {
+		msg("Autosave failed!");
+		event_signal(EVENT_MESSAGE_FLUSH);
+	}
+}
+
+/**
+ * Save the game on a change of level.  The savefile is written in the
+ * background where possible.  The window prefs and lore.txt are left for
+ * the next full save, since writing them would hold up play just the same.
+ */
+void autosave_game(void)
+{
+	/* Report a failure of the last one */
+	check_autosave();
+
+	/* Disturb the player */
+	disturb(player);
+
+	/* Handle stuff */
+	handle_stuff(player);
+
+	/* The player is not dead */
+	my_strcpy(player->died_from, "(saved)", sizeof(player->died_from));
+
+	/* Save the player, with suspend forbidden while taking the snapshot */
+	signals_ignore_tstp();
+	savefile_save_background(savefile);
+	signals_handle_tstp();
+}
+
 /**
  * Save the game.
  *
@@ -1006,6 +1063,9 @@ bool save_game_checked(void)
 	char path[1024];
 	bool result;
 
+	/* Report a failed autosave before this save replaces it */
+	check_autosave();
+
 	/* Disturb the player */
 	disturb(player);
 
@@ -1110,6 +1170,7 @@ void close_game(bool prompt_failed_save)
 		death_screen();
 
 		/* Save dead player */
+		check_autosave();
 		while (prompting && !savefile_save(savefile)) {
 			if (!prompt_failed_save
 					|| !get_check("Saving failed.  Try again? ")) {
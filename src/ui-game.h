@@ -57,6 +57,7 @@ struct savefile_details {
 extern bool arg_wizard;
 extern char savefile[1024];
 extern char panicfile[1024];
+extern char recordfile[1024];
 extern void (*reinit_hook)(void);
 
 void cmd_init(void);
@@ -74,6 +75,7 @@ bool savefile_name_already_used(const char *fname, bool make_safe,
 	bool strip_suffix);
 void save_game(void);
 bool save_game_checked(void);
+void autosave_game(void);
 void close_game(bool prompt_failed_save);
 
 bool got_savefile(savefile_getter *pg);
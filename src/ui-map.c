@@ -37,12 +37,15 @@
 
 /**
  * Hack -- Hallucinatory monster
+ *
+ * This and hallucinatory_object() leave the game's random numbers alone, so
+ * what's drawn can't change how the game plays out.
  */
 static void hallucinatory_monster(int *a, wchar_t *c)
 {
 	while (1) {
 		/* Select a random monster */
-		struct monster_race *race = &r_info[randint0(z_info->r_max)];
+		struct monster_race *race = &r_info[Rand_simple(z_info->r_max)];
 		
 		/* Skip non-entries */
 		if (!race->name) continue;
@@ -63,7 +66,7 @@ static void hallucinatory_object(int *a, wchar_t *c)
 	
 	while (1) {
 		/* Select a random object */
-		struct object_kind *kind = &k_info[randint0(z_info->k_max - 1) + 1];
+		struct object_kind *kind = &k_info[Rand_simple(z_info->k_max - 1) + 1];
 
 		/* Skip non-entries */
 		if (!kind->name) continue;
@@ -123,7 +123,7 @@ static const char *random_hint(void)
 	struct hint *v, *r = NULL;
 	int n;
 	for (v = hints, n = 1; v; v = v->next, n++)
-		if (one_in_(n))
+		if (!Rand_simple(n))
 			r = v;
 	return r->hint;
 }
@@ -135,6 +135,9 @@ static const char *random_hint(void)
  * Taken and modified from Sangband 1.0.
  *
  * Note that each comment_hint should have exactly one %s
+ *
+ * The choices here use Rand_simple(), as random_hint() does, so a visit to a
+ * store doesn't change the game's random numbers.
  */
 static void prt_welcome(const struct owner *proprietor)
 {
@@ -143,7 +146,7 @@ static void prt_welcome(const struct owner *proprietor)
 
 	int j;
 
-	if (one_in_(2))
+	if (Rand_simple(2))
 		return;
 
 	/* Get the first name of the store owner (stop before the first space) */
@@ -153,8 +156,8 @@ static void prt_welcome(const struct owner *proprietor)
 	/* Truncate the name */
 	short_name[j] = '\0';
 
-	if (one_in_(3)) {
-		size_t i = randint0(N_ELEMENTS(comment_hint));
+	if (!Rand_simple(3)) {
+		size_t i = Rand_simple(N_ELEMENTS(comment_hint));
 		msg(comment_hint[i], random_hint());
 	} else if (player->lev > 5) {
 		const char *player_name;
@@ -164,9 +167,9 @@ static void prt_welcome(const struct owner *proprietor)
 		i = MIN(i, N_ELEMENTS(comment_welcome) - 1);
 
 		/* Get a title for the character */
-		if ((i % 2) && randint0(2))
+		if ((i % 2) && Rand_simple(2))
 			player_name = player->class->title[(player->lev - 1) / 5];
-		else if (randint0(2))
+		else if (Rand_simple(2))
 			player_name = player->full_name;
 		else
 			player_name = "valued customer";
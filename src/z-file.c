@@ -847,8 +847,16 @@ struct ang_file
 	FILE *fh;
 	char *fname;
 	file_mode mode;
+
+	/* Read buffer; bytes rpos up to rlen have not been handed out yet */
+	char *rbuf;
+	size_t rpos;
+	size_t rlen;
 };
 
+/* Size of the read buffer */
+#define FILE_READ_BUF 4096
+
 
 
 /** Utility functions **/
@@ -1060,6 +1068,7 @@ bool file_close(ang_file *f)
 	if (fclose(f->fh) != 0)
 		return false;
 
+	mem_free(f->rbuf);
 	mem_free(f->fname);
 	mem_free(f);
 
@@ -1105,11 +1114,48 @@ void file_unlock(ang_file *f)
 
 /** Byte-based IO and functions **/
 
+/**
+ * Refill the read buffer of file 'f'.  Returns false if there was nothing
+ * more to read.
+ */
+static bool file_fill(ang_file *f)
+{
+	size_t read;
+
+	if (!f->rbuf)
+		f->rbuf = mem_alloc(FILE_READ_BUF);
+
+	read = fread(f->rbuf, 1, FILE_READ_BUF, f->fh);
+	f->rpos = 0;
+	f->rlen = read;
+
+	return read > 0;
+}
+
+/**
+ * Give back whatever is left in the read buffer of file 'f', so the
+ * underlying file position is where the caller thinks it is.
+ */
+static void file_unbuffer(ang_file *f)
+{
+	if (f->rlen) {
+		fseek(f->fh, -(long) (f->rlen - f->rpos), SEEK_CUR);
+		f->rpos = f->rlen = 0;
+	}
+}
+
 /**
  * Seek to location 'pos' in file 'f'.
  */
 bool file_skip(ang_file *f, int bytes)
 {
+	/* Stay within the read buffer if possible */
+	if (bytes >= 0 && (size_t) bytes <= f->rlen - f->rpos) {
+		f->rpos += bytes;
+		return true;
+	}
+
+	file_unbuffer(f);
 	return (fseek(f->fh, bytes, SEEK_CUR) == 0);
 }
 
@@ -1118,12 +1164,10 @@ bool file_skip(ang_file *f, int bytes)
  */
 bool file_readc(ang_file *f, uint8_t *b)
 {
-	int i = fgetc(f->fh);
-
-	if (i == EOF)
+	if (f->rpos == f->rlen && !file_fill(f))
 		return false;
 
-	*b = (uint8_t)i;
+	*b = (uint8_t) f->rbuf[f->rpos++];
 	return true;
 }
 
@@ -1140,12 +1184,22 @@ bool file_writec(ang_file *f, uint8_t b)
  */
 int file_read(ang_file *f, char *buf, size_t n)
 {
-	size_t read = fread(buf, 1, n, f->fh);
+	size_t buffered = MIN(n, f->rlen - f->rpos);
+	size_t read;
+
+	/* Use up the read buffer first */
+	if (buffered) {
+		memcpy(buf, f->rbuf + f->rpos, buffered);
+		f->rpos += buffered;
+		if (buffered == n) return n;
+	}
 
-	if (read == 0 && ferror(f->fh))
+	read = fread(buf + buffered, 1, n - buffered, f->fh);
+
+	if (read == 0 && !buffered && ferror(f->fh))
 		return -1;
 	else
-		return read;
+		return buffered + read;
 }
 
 /**
@@ -1153,6 +1207,7 @@ int file_read(ang_file *f, char *buf, size_t n)
  */
 bool file_write(ang_file *f, const char *buf, size_t n)
 {
+	file_unbuffer(f);
 	return fwrite(buf, 1, n, f->fh) == n;
 }
 
@@ -1163,13 +1218,16 @@ bool file_write(ang_file *f, const char *buf, size_t n)
  *
  * Support both \r\n and \n as line endings, but not the outdated \r that used
  * to be used on Macs.  Replace non-printables with '?', and \ts with ' '.
+ *
+ * This works straight from the file's read buffer; a \r is only taken as
+ * part of the line ending once the byte after it has been looked at, so there
+ * is never a need to step back in the file.
  */
 #define TAB_COLUMNS 4
 
 bool file_getl(ang_file *f, char *buf, size_t len)
 {
 	bool seen_cr = false;
-	uint8_t b;
 	size_t i = 0;
 
 	/* Leave a byte for the terminating 0 */
@@ -1178,24 +1236,27 @@ bool file_getl(ang_file *f, char *buf, size_t len)
 	while (i < max_len) {
 		char c;
 
-		if (!file_readc(f, &b)) {
+		if (f->rpos == f->rlen && !file_fill(f)) {
 			buf[i] = '\0';
 			return (i == 0) ? false : true;
 		}
 
-		c = (char) b;
+		c = f->rbuf[f->rpos];
 
 		if (c == '\r') {
 			seen_cr = true;
+			f->rpos++;
 			continue;
 		}
 
+		/* Leave whatever follows a lone \r for the next line */
 		if (seen_cr && c != '\n') {
-			fseek(f->fh, -1, SEEK_CUR);
 			buf[i] = '\0';
 			return true;
 		}
 
+		f->rpos++;
+
 		if (c == '\n') {
 			buf[i] = '\0';
 			return true;
@@ -26,16 +26,50 @@ static char **quarks;
 static size_t nr_quarks = 1;
 static size_t alloc_quarks = 0;
 
+/**
+ * Open-addressed index of the quarks by string hash; each slot holds a quark
+ * or zero if it is empty.  It is kept at most half full.
+ */
+static quark_t *quark_index;
+static size_t alloc_index = 0;
+
 #define QUARKS_INIT	16
 
+/**
+ * Find the slot in the index where str is, or should go.
+ */
+static size_t quark_slot(const char *str)
+{
+	size_t mask = alloc_index - 1;
+	size_t i = djb2_hash(str) & mask;
+
+	while (quark_index[i] && !streq(quarks[quark_index[i]], str))
+		i = (i + 1) & mask;
+
+	return i;
+}
+
+/**
+ * Double the size of the index and put all the quarks back into it.
+ */
+static void quark_index_grow(void)
+{
+	quark_t q;
+
+	mem_free(quark_index);
+	alloc_index *= 2;
+	quark_index = mem_zalloc(alloc_index * sizeof(quark_t));
+	for (q = 1; q < nr_quarks; q++)
+		quark_index[quark_slot(quarks[q])] = q;
+}
+
 quark_t quark_add(const char *str)
 {
 	quark_t q;
+	size_t slot = quark_slot(str);
 
-	for (q = 1; q < nr_quarks; q++) {
-		if (streq(quarks[q], str))
-			return q;
-	}
+	if (quark_index[slot])
+		return quark_index[slot];
 
 	if (nr_quarks == alloc_quarks) {
 		alloc_quarks *= 2;
@@ -44,6 +78,11 @@ quark_t quark_add(const char *str)
 
 	q = nr_quarks++;
 	quarks[q] = string_make(str);
+	quark_index[slot] = q;
+
+	/* Keep the index sparse so probes stay short */
+	if (nr_quarks * 2 > alloc_index)
+		quark_index_grow();
 
 	return q;
 }
@@ -58,6 +97,8 @@ void quarks_init(void)
 	nr_quarks = 1;
 	alloc_quarks = QUARKS_INIT;
 	quarks = mem_zalloc(alloc_quarks * sizeof(char*));
+	alloc_index = QUARKS_INIT * 2;
+	quark_index = mem_zalloc(alloc_index * sizeof(quark_t));
 }
 
 void quarks_free(void)
@@ -68,6 +109,7 @@ void quarks_free(void)
 	for (i = 1; i < nr_quarks; i++)
 		string_free(quarks[i]);
 
+	mem_free(quark_index);
 	mem_free(quarks);
 }
 
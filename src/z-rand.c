@@ -18,6 +18,7 @@
  *    are included in all such copies.  Other copyrights may also apply.
  */
 #include "z-rand.h"
+#include "z-virt.h"
 #ifdef _WIN32
 #include <windows.h> /* GetCurrentProcessId() */
 #endif
@@ -105,6 +106,9 @@ void Rand_state_init(uint32_t seed)
 {
 	int i, j;
 
+	/* Start from the same place, so the seed alone decides what follows */
+	state_i = 0;
+
 	/* Seed the table */
 	STATE[0] = seed;
 
@@ -560,6 +564,91 @@ int random_chance_scaled(random_chance c, int scale)
 	return scale * c.numerator / c.denominator;
 }
 
+/**
+ * Build an alias table using Vose's method.  Each weight is scaled by the
+ * number of choices so the average is the total weight; choices below the
+ * average are topped up from those above it, which keeps everything in
+ * integers and the probabilities exact.
+ */
+struct rand_alias *Rand_alias_new(const uint32_t *weight, int count)
+{
+	struct rand_alias *table;
+	uint64_t total = 0, *scaled;
+	int *small, *large;
+	int i, num_small = 0, num_large = 0;
+
+	for (i = 0; i < count; i++) {
+		total += weight[i];
+	}
+	if (!total || total > UINT32_MAX) return NULL;
+
+	table = mem_zalloc(sizeof(*table));
+	table->count = count;
+	table->total = (uint32_t) total;
+	table->keep = mem_zalloc(count * sizeof(*table->keep));
+	table->alias = mem_zalloc(count * sizeof(*table->alias));
+
+	scaled = mem_zalloc(count * sizeof(*scaled));
+	small = mem_zalloc(count * sizeof(*small));
+	large = mem_zalloc(count * sizeof(*large));
+	for (i = 0; i < count; i++) {
+		scaled[i] = (uint64_t) weight[i] * count;
+		if (scaled[i] < total) {
+			small[num_small++] = i;
+		} else {
+			large[num_large++] = i;
+		}
+	}
+
+	/* Pair each small choice with a large one to make up its column */
+	while (num_small && num_large) {
+		int s = small[--num_small], l = large[num_large - 1];
+
+		table->keep[s] = (uint32_t) scaled[s];
+		table->alias[s] = l;
+		scaled[l] -= total - scaled[s];
+		if (scaled[l] < total) {
+			num_large--;
+			small[num_small++] = l;
+		}
+	}
+
+	/* Whatever is left fills its own column exactly */
+	while (num_large) {
+		int l = large[--num_large];
+
+		table->keep[l] = table->total;
+		table->alias[l] = l;
+	}
+	while (num_small) {
+		int s = small[--num_small];
+
+		table->keep[s] = table->total;
+		table->alias[s] = s;
+	}
+
+	mem_free(large);
+	mem_free(small);
+	mem_free(scaled);
+	return table;
+}
+
+void Rand_alias_free(struct rand_alias *table)
+{
+	if (!table) return;
+	mem_free(table->alias);
+	mem_free(table->keep);
+	mem_free(table);
+}
+
+int Rand_alias(const struct rand_alias *table)
+{
+	int i = randint0(table->count);
+
+	if (table->keep[i] == table->total) return i;
+	return (Rand_div(table->total) < table->keep[i]) ? i : table->alias[i];
+}
+
 /**
  * Cause the output from Rand_div() to be fixed rather than random.
  *
@@ -203,6 +203,34 @@ bool random_chance_check(random_chance c);
 
 int random_chance_scaled(random_chance c, int scale);
 
+/**
+ * A table for picking from a fixed set of weighted choices in constant time,
+ * using Walker's alias method.
+ */
+struct rand_alias {
+	int count;		/* Number of choices */
+	uint32_t total;		/* Sum of the weights */
+	uint32_t *keep;		/* Chance, out of total, of keeping each choice */
+	int *alias;		/* Choice to take instead */
+};
+
+/**
+ * Build an alias table for `count` choices with the given weights.  Returns
+ * NULL if all the weights are zero.
+ */
+struct rand_alias *Rand_alias_new(const uint32_t *weight, int count);
+
+/**
+ * Free an alias table.
+ */
+void Rand_alias_free(struct rand_alias *table);
+
+/**
+ * Pick a choice from an alias table, with probability proportional to its
+ * weight.
+ */
+int Rand_alias(const struct rand_alias *table);
+
 extern void rand_fix(uint32_t val);
 
 #endif /* INCLUDED_Z_RAND_H */
@@ -18,6 +18,24 @@
 #include "z-virt.h"
 #include "z-util.h"
 
+/**
+ * The allocation count is kept per thread, so that a background savefile
+ * writer's allocations don't race with, or add to, a benchmark's count
+ */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+# define MEM_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+# define MEM_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+# define MEM_THREAD_LOCAL __declspec(thread)
+#else
+/* Without it, counts also include other threads' allocations */
+# define MEM_THREAD_LOCAL
+#endif
+
+static MEM_THREAD_LOCAL bool mem_counting;
+static MEM_THREAD_LOCAL unsigned long mem_count;
+
 /**
  * Allocate `len` bytes of memory.
  *
@@ -38,6 +56,8 @@ void *mem_alloc(size_t len)
 	void *p = malloc(len);
 	if (!p)
 		quit("Out of memory!");
+	if (mem_counting)
+		mem_count++;
 	return p;
 }
 
@@ -64,9 +84,29 @@ void *mem_realloc(void *p, size_t len)
 	p = realloc(p, len);
 	if (!p)
 		quit("Out of Memory!");
+	if (mem_counting)
+		mem_count++;
 	return p;
 }
 
+/**
+ * Start counting allocations from zero
+ */
+void mem_count_begin(void)
+{
+	mem_count = 0;
+	mem_counting = true;
+}
+
+/**
+ * Stop counting allocations, and return the number since mem_count_begin()
+ */
+unsigned long mem_count_end(void)
+{
+	mem_counting = false;
+	return mem_count;
+}
+
 /**
  * Duplicates an existing string `str`, allocating as much memory as necessary.
  */
@@ -23,6 +23,13 @@ void *mem_zalloc(size_t len);
 void mem_free(void *p);
 void *mem_realloc(void *p, size_t len);
 
+/**
+ * Counting of the calls to mem_alloc() and mem_realloc(), for benchmarks.
+ * Only the calls made by the thread that called mem_count_begin() are counted.
+ */
+void mem_count_begin(void);
+unsigned long mem_count_end(void);
+
 /**
  * On NDS, we might need to allocate some data into external memory
  * with additional restrictions (no 8-bit writes). These "alt" methods